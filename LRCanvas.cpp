@@ -0,0 +1,149 @@
+//
+// Lucky Resistor's MeggyJr Canvas
+// ---------------------------------------------------------------------------
+// (c)2014 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "LRCanvas.h"
+
+
+namespace lr {
+
+
+Canvas::Canvas(uint8_t *data, const uint8_t width, const uint8_t height)
+    : _data(data), _width(width), _height(height), _progMem(false)
+{
+}
+
+    
+Canvas Canvas::fromProgMem(const uint8_t *data, const uint8_t width, const uint8_t height)
+{
+    Canvas canvas(const_cast<uint8_t*>(data), width, height);
+    canvas._progMem = true;
+    return canvas;
+}
+
+    
+void Canvas::clear()
+{
+    if (!_progMem) {
+        memset(_data, 0, LRCANVAS_SIZE(_width, _height));
+    }
+}
+
+    
+void Canvas::setPixel(uint8_t x, uint8_t y, const Color &color)
+{
+    if (_progMem) {
+        return;
+    }
+    const uint16_t c = color._color;
+    uint8_t* const target = &_data[(y>>1)*3+x*getColumnSize()];
+    if ((y & 1) == 0) {
+        target[0] = c >> 4;
+        target[1] = (target[1] & 0x0F) | ((c << 4) & 0xFF);
+    } else {
+        target[1] = (target[1] & 0xF0) | (c >> 8);
+        target[2] = c & 0xFF;
+    }
+}
+
+    
+void Canvas::setPixelS(int16_t x, int16_t y, const Color &color)
+{
+    if (x>=0 && y>=0 && x<_width && y<_height) {
+        setPixel(x, y, color);
+    }
+}
+
+    
+Color Canvas::getPixel(uint8_t x, uint8_t y) const
+{
+    return Color(readColorValue(x, y));
+}
+
+    
+Color Canvas::getPixelS(int16_t x, int16_t y) const
+{
+    if (x>=0 && y>=0 && x<_width && y<_height) {
+        return getPixel(x, y);
+    } else {
+        return Color::black();
+    }
+}
+
+    
+void Canvas::render(int16_t x, int16_t y, bool wrap, uint8_t *matrix) const
+{
+    const uint16_t columnSize = getColumnSize();
+    const bool copyColumns = ((y & 1) == 0 && y >= 0 && y+8 <= _height);
+    for (uint8_t dx = 0; dx < 8; ++dx, matrix += 12) {
+        int16_t cx = x + dx;
+        if (wrap && cx >= _width) {
+            cx -= _width;
+        }
+        if (cx < 0 || cx >= _width) {
+            memset(matrix, 0, 12);
+            continue;
+        }
+        const uint16_t offset = cx*columnSize;
+        if (copyColumns) {
+            const uint8_t *src = _data + offset + (y>>1)*3;
+            if (_progMem) {
+                memcpy_P(matrix, src, 12);
+            } else {
+                memcpy(matrix, src, 12);
+            }
+        } else {
+            for (uint8_t dy = 0; dy < 8; ++dy) {
+                int16_t cy = y + dy;
+                if (wrap && cy >= _height) {
+                    cy -= _height;
+                }
+                uint16_t c = 0;
+                if (cy >= 0 && cy < _height) {
+                    c = readColorValue(cx, cy);
+                }
+                uint8_t* const target = &matrix[(dy>>1)*3];
+                if ((dy & 1) == 0) {
+                    target[0] = c >> 4;
+                    target[1] = (target[1] & 0x0F) | ((c << 4) & 0xFF);
+                } else {
+                    target[1] = (target[1] & 0xF0) | (c >> 8);
+                    target[2] = c & 0xFF;
+                }
+            }
+        }
+    }
+}
+
+    
+uint16_t Canvas::readColorValue(uint8_t x, uint8_t y) const
+{
+    const uint16_t offset = (y>>1)*3+x*getColumnSize();
+    if ((y & 1) == 0) {
+        return ((uint16_t)readByte(offset) << 4) | (readByte(offset+1) >> 4);
+    } else {
+        return ((uint16_t)(readByte(offset+1) & 0x0F) << 8) | readByte(offset+2);
+    }
+}
+
+
+}
+
+// End of File
+// ----------------------------------------------------------------------------
+//
@@ -0,0 +1,161 @@
+#pragma once
+//
+// Lucky Resistor's MeggyJr Canvas
+// ---------------------------------------------------------------------------
+// (c)2014 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "Arduino.h"
+
+#include "LRColor.h"
+
+
+namespace lr {
+
+
+// Forward declaration.
+class MeggyJr;
+
+
+/// A virtual canvas which can be larger than the display.
+///
+/// The canvas uses the same packed format as the display: The pixels are
+/// stored column by column, two pixels in three bytes. Therefore the height
+/// has to be a multiple of 2. Use the LRCANVAS_SIZE() macro to get the
+/// required size for the data.
+///
+/// Attach the canvas to the display using MeggyJr::setCanvas(). The
+/// display shows the part of the canvas selected with the viewport, so
+/// scrolling is just changing the viewport position.
+///
+/// A canvas in program memory is read-only. All "set" calls are ignored.
+///
+class Canvas
+{
+    friend class MeggyJr;
+    
+public:
+    /// Create a new canvas in SRAM.
+    ///
+    /// @param data The data for the canvas, with LRCANVAS_SIZE(width, height) bytes.
+    /// @param width The width of the canvas in pixels (8-255).
+    /// @param height The height of the canvas in pixels (8-254, a multiple of 2).
+    ///
+    Canvas(uint8_t *data, const uint8_t width, const uint8_t height);
+    
+    /// Create a read-only canvas from data in program memory.
+    ///
+    /// @param data The data for the canvas in PROGMEM, with LRCANVAS_SIZE(width, height) bytes.
+    /// @param width The width of the canvas in pixels (8-255).
+    /// @param height The height of the canvas in pixels (8-254, a multiple of 2).
+    ///
+    static Canvas fromProgMem(const uint8_t *data, const uint8_t width, const uint8_t height);
+    
+public:
+    /// Get the width of the canvas.
+    ///
+    inline uint8_t getWidth() const { return _width; }
+    
+    /// Get the height of the canvas.
+    ///
+    inline uint8_t getHeight() const { return _height; }
+    
+    /// Check if the canvas is in program memory.
+    ///
+    inline bool isInProgMem() const { return _progMem; }
+    
+    /// Clear all pixels of the canvas.
+    ///
+    void clear();
+    
+    /// Set the color of a pixel.
+    ///
+    /// @param x The x position of the pixel.
+    /// @param y The y position of the pixel.
+    /// @param color The color for the pixel.
+    ///
+    void setPixel(uint8_t x, uint8_t y, const Color &color);
+    
+    /// Set the color of a pixel ignore pixels outside of the canvas.
+    ///
+    /// @param x The x position of the pixel.
+    /// @param y The y position of the pixel.
+    /// @param color The color for the pixel.
+    ///
+    void setPixelS(int16_t x, int16_t y, const Color &color);
+    
+    /// Get the color of a pixel.
+    ///
+    /// @param x The x position of the pixel.
+    /// @param y The y position of the pixel.
+    /// @return The color of the pixel.
+    ///
+    Color getPixel(uint8_t x, uint8_t y) const;
+    
+    /// Get the color of a pixel ignore pixels outside of the canvas.
+    ///
+    /// @param x The x position of the pixel.
+    /// @param y The y position of the pixel.
+    /// @return The color of the pixel or black if the pixel is outside of the canvas.
+    ///
+    Color getPixelS(int16_t x, int16_t y) const;
+    
+    /// Render an 8x8 part of the canvas in the packed display format.
+    ///
+    /// If the part starts at an even row and does not wrap, each column
+    /// is just copied. Otherwise the pixels are copied one by one. Pixels
+    /// outside of the canvas are black.
+    ///
+    /// @param x The x position of the top left corner of the part.
+    /// @param y The y position of the top left corner of the part.
+    /// @param wrap true to wrap around at the edges of the canvas.
+    /// @param matrix The 96 bytes to render the part into.
+    ///
+    void render(int16_t x, int16_t y, bool wrap, uint8_t *matrix) const;
+    
+private:
+    /// Get the size of one column in bytes.
+    ///
+    inline uint16_t getColumnSize() const { return (uint16_t)(_height >> 1) * 3; }
+    
+    /// Read a byte from the canvas data.
+    ///
+    inline uint8_t readByte(const uint16_t offset) const {
+        return _progMem ? pgm_read_byte(_data + offset) : _data[offset];
+    }
+    
+    /// Read the 12 bit color value of a pixel.
+    ///
+    uint16_t readColorValue(uint8_t x, uint8_t y) const;
+    
+private:
+    uint8_t *_data;
+    uint8_t _width;
+    uint8_t _height;
+    bool _progMem;
+};
+
+
+/// Use this macro to get the size of the data for a canvas in bytes.
+///
+#define LRCANVAS_SIZE(width, height) ((uint16_t)(width)*((height)/2)*3)
+
+
+}
+
+
@@ -30,6 +30,7 @@ namespace lr {
 
 // Forward declaration.
 class MeggyJr;
+class Canvas;
 
 
 /// This represents a RGB color
@@ -37,6 +38,7 @@ class MeggyJr;
 class Color
 {
     friend class MeggyJr;
+    friend class Canvas;
     
 public:
     /// Create a new color.
@@ -19,6 +19,8 @@
 //
 #include "LRMeggyJr.h"
 
+#include <avr/sleep.h>
+
 
 // Details about the mapping from the Hardware to the Controller
 // ---------------------------------------------------------------------------
@@ -94,34 +96,620 @@ const uint8_t brightnessLevels = 16;
 
 // The mask for the brightness levels.
 const uint8_t brightnessLevelsMask = 0x0F;
+
+// The number of bit planes for the BCM driver (bits per color channel).
+const uint8_t bitPlanes = 4;
+
+// The timer units for the shortest BCM time slot. (15 units for each row)
+const uint8_t bcmSlotUnit = F_CPU / 64 /*prescale*/ / 8 /*rows*/ / 15 /*units*/ / 120 /*FPS*/;
     
 // The size of the matrix in bytes
 const uint8_t ledMatrixSize = 96;
     
 // The size of a row in the matrix
 const uint8_t ledMatrixRowSize = 12;
+
+// The size of the index image in palette mode (4 bits for each pixel).
+const uint8_t paletteImageSize = 32;
+
+// The size of a row in the index image.
+const uint8_t paletteImageRowSize = 4;
+
+// The number of colors in the palette.
+const uint8_t paletteSize = 16;
+
+// The size of the matrix for drawing in palette mode (index image and palette).
+const uint8_t paletteBufferSize = paletteImageSize + paletteSize*2;
+
+// The size of the fraction bits in high color mode (2 bits for each channel).
+const uint8_t highColorFractionSize = 48;
+
+// The size of a row of the fraction bits.
+const uint8_t highColorFractionRowSize = 6;
     
 // The LED matrix
 // ---------------------------------------------------------------------------
     
-// A matrix with the colors for all 64 LEDs.
+// The statically allocated matrix, which is displayed after the setup.
+uint8_t ledMatrixStaticBuffer[ledMatrixSize];
+
+// Two matrixes with the colors for all 64 LEDs. The application draws into
+// one of them ("ledMatrix"), the other one is displayed ("displayedLedMatrix").
 // Each row has the format RG BR GB  RG BR GB  RG BR GB  RG BR GB.
-uint8_t ledMatrix[ledMatrixSize];
-    
+// The matrix for drawing is allocated in setup(), in palette mode with only
+// paletteBufferSize bytes. Until then, both point to the static matrix.
+uint8_t *ledMatrixBuffers[2] = {ledMatrixStaticBuffer, ledMatrixStaticBuffer};
+
+// The index of the buffer the application draws into.
+// Page flipping just toggles this index. It is a single byte, so
+// the application can read it while the display driver changes it.
+uint8_t ledMatrixIndex;
+
 // The led matrix which is actually dislayed (backbuffer)
-uint8_t displayedLedMatrix[ledMatrixSize];
+// For the BCM driver, this matrix contains the bit planes for all rows.
+// Each row has the format R0 G0 B0  R1 G1 B1  R2 G2 B2  R3 G3 B3,
+// where each byte contains the bit of one plane for all 8 LEDs in the row.
+uint8_t *displayedLedMatrix;
+
+// Get the led matrix the application draws into.
+inline uint8_t* ledMatrix()
+{
+    return ledMatrixBuffers[ledMatrixIndex];
+}
+
+// In palette mode, the matrix the application draws into contains
+// only the index image and the palette. The displayed matrix is the only
+// matrix with 96 bytes, the driver resolves the colors into it.
+// Each row of the index image has the format 01 23 45 67.
+
+// Get the index image the application draws into.
+inline uint8_t* paletteImage()
+{
+    return ledMatrix();
+}
+
+// Get the palette with the colors.
+inline uint16_t* palette()
+{
+    return reinterpret_cast<uint16_t*>(ledMatrix() + paletteImageSize);
+}
+
+// Set a single pixel in a column of the led matrix.
+inline void ledMatrixSetPixel(uint8_t *column, const uint8_t y, const uint16_t color)
+{
+    uint8_t* const target = column + (y>>1)*3;
+    if ((y & 1) == 0) {
+        target[0] = color >> 4;
+        target[1] = (target[1] & 0x0F) | ((color << 4) & 0xFF);
+    } else {
+        target[1] = (target[1] & 0xF0) | (color >> 8);
+        target[2] = color & 0xFF;
+    }
+}
+
+// Pack a color into the three bytes of a pixel pair (RG BR GB),
+// where both pixels have the same color.
+inline void ledMatrixPackPair(const uint16_t color, uint8_t *pair)
+{
+    pair[0] = color >> 4;
+    pair[1] = (color << 4) | (color >> 8);
+    pair[2] = color;
+}
+
+// Fill a vertical span in a column of the led matrix with a packed pair.
+// Full pairs are written with three stores, only the pixels at the ends
+// of the span need a nibble merge.
+static void ledMatrixFillVerticalSpan(uint8_t *column, uint8_t y, uint8_t height, const uint8_t *pair)
+{
+    uint8_t *target = column + (y>>1)*3;
+    const uint8_t end = y + height;
+    if ((y & 1) != 0 && y < end) {
+        target[1] = (target[1] & 0xF0) | (pair[1] & 0x0F);
+        target[2] = pair[2];
+        target += 3;
+        ++y;
+    }
+    while (y + 1 < end) {
+        target[0] = pair[0];
+        target[1] = pair[1];
+        target[2] = pair[2];
+        target += 3;
+        y += 2;
+    }
+    if (y < end) {
+        target[0] = pair[0];
+        target[1] = (target[1] & 0x0F) | (pair[1] & 0xF0);
+    }
+}
+
+// Combine a single pixel in a column of the led matrix with a color.
+// The operations work on the packed nibbles, so each pixel only needs
+// two read-modify-write operations on the bytes.
+static void ledMatrixBlitPixel(uint8_t *column, const uint8_t y, const uint16_t color, const uint8_t blitMode)
+{
+    uint8_t *target = column + (y>>1)*3;
+    uint8_t value0;
+    uint8_t value1;
+    uint8_t mask0;
+    uint8_t mask1;
+    if ((y & 1) == 0) {
+        value0 = color >> 4;
+        value1 = (color << 4) & 0xF0;
+        mask0 = 0xFF;
+        mask1 = 0xF0;
+    } else {
+        ++target;
+        value0 = (color >> 8) & 0x0F;
+        value1 = color & 0xFF;
+        mask0 = 0x0F;
+        mask1 = 0xFF;
+    }
+    switch (blitMode) {
+        case MeggyJr::BlitOr:
+            target[0] |= value0;
+            target[1] |= value1;
+            break;
+        
+        case MeggyJr::BlitXor:
+            target[0] ^= value0;
+            target[1] ^= value1;
+            break;
+        
+        case MeggyJr::BlitAndNot:
+            target[0] &= ~value0;
+            target[1] &= ~value1;
+            break;
+        
+        case MeggyJr::BlitOntoBlack:
+            if ((target[0] & mask0) != 0 || (target[1] & mask1) != 0) {
+                break;
+            }
+            // fall through
+        
+        default:
+            target[0] = (target[0] & ~mask0) | value0;
+            target[1] = (target[1] & ~mask1) | value1;
+            break;
+    }
+}
+
+// Spread the two nibbles of a byte into the two bytes of a word (0xAB -> 0x0A0B).
+// This gives each color channel 4 spare bits, so two channels can be calculated
+// with one 16 bit operation.
+inline uint16_t nibbleSpread(const uint8_t value)
+{
+    return (value & 0x0F) | ((uint16_t)(value & 0xF0) << 4);
+}
+
+// Join two spread nibbles back into one byte (0x0A0B -> 0xAB).
+inline uint8_t nibbleJoin(const uint16_t value)
+{
+    return (value & 0x0F) | ((value >> 4) & 0xF0);
+}
+
+// Multiply both nibbles of a byte with factor/16.
+inline uint8_t nibbleScale(const uint8_t value, const uint8_t factor)
+{
+    // Each product is at most 15*16, so it fits into its 8 bit lane.
+    return nibbleJoin((nibbleSpread(value) * factor) >> 4);
+}
+
+// Move both nibbles of a byte one step toward the nibbles of the target.
+inline uint8_t nibbleStepToward(const uint8_t value, const uint16_t spreadTarget)
+{
+    const uint16_t current = nibbleSpread(value);
+    // Each lane is 0x80+target-current, there is no borrow between the lanes.
+    const uint16_t difference = (spreadTarget | 0x8080) - current;
+    const uint16_t up = ((difference - 0x0101) & 0x8080) >> 7;
+    const uint16_t down = (~difference & 0x8080) >> 7;
+    return nibbleJoin(current + up - down);
+}
+
+// Add both nibbles of two bytes, limited to 15.
+inline uint8_t nibbleAddSaturate(const uint8_t a, const uint8_t b)
+{
+    const uint16_t sum = nibbleSpread(a) + nibbleSpread(b);
+    const uint16_t overflow = (sum & 0x1010) >> 4;
+    return nibbleJoin(sum | ((overflow << 4) - overflow));
+}
+
+// The average of both nibbles of two bytes, rounded down.
+inline uint8_t nibbleAverage(const uint8_t a, const uint8_t b)
+{
+    // The shared bits plus half of the different bits, the mask
+    // prevents the high nibble from shifting into the low nibble.
+    return (a & b) + (((a ^ b) & 0xEE) >> 1);
+}
+
+// Clear the high color fraction bits of a single pixel in a row of
+// fraction bits. The 6 bits of the three channels repeat their position
+// every 4 pixels, which are 3 bytes.
+inline void fractionClearPixel(uint8_t *row, const uint8_t y)
+{
+    uint8_t* const bits = row + (y>>2)*3;
+    switch (y & 0x3) {
+        case 0:
+            bits[0] &= 0x03;
+            break;
+        case 1:
+            bits[0] &= 0xFC;
+            bits[1] &= 0x0F;
+            break;
+        case 2:
+            bits[1] &= 0xF0;
+            bits[2] &= 0x3F;
+            break;
+        default:
+            bits[2] &= 0xC0;
+            break;
+    }
+}
+
+// Draw a palette indexed sprite with 2 or 4 bits for each pixel.
+// The visible part of the sprite is calculated once, so the loops
+// only visit pixels which are on the screen. If "fraction" points to the
+// high color fraction bits, the bits of each drawn pixel are cleared.
+static void ledMatrixDrawIndexedSprite(const uint8_t *spriteData, const uint8_t bitsPerPixel, const uint8_t width, const uint8_t height, const int8_t x, const int8_t y, const uint16_t *palette, const uint8_t blitMode, uint8_t *fraction)
+{
+    // Clip the sprite.
+    if (x >= numberOfRows || y >= numberOfRows || x + width <= 0 || y + height <= 0) {
+        return;
+    }
+    const uint8_t startX = (x < 0) ? -x : 0;
+    const uint8_t startY = (y < 0) ? -y : 0;
+    const uint8_t endX = (x + width > numberOfRows) ? (numberOfRows - x) : width;
+    const uint8_t endY = (y + height > numberOfRows) ? (numberOfRows - y) : height;
+    // Copy the used palette from program memory.
+    const uint8_t colorCount = (1 << bitsPerPixel);
+    uint16_t colors[16];
+    for (uint8_t i = 1; i < colorCount; ++i) {
+        colors[i] = pgm_read_word(palette + i);
+    }
+    const uint8_t rowSize = bitsPerPixel; // 8 pixels with 2 or 4 bits.
+    const uint8_t mask = colorCount - 1;
+    uint8_t *column = &ledMatrix()[(x + startX)*ledMatrixRowSize];
+    if (fraction != 0) {
+        fraction += (x + startX)*highColorFractionRowSize;
+    }
+    for (uint8_t dx = startX; dx < endX; ++dx) {
+        // The byte and shift of this pixel in each row.
+        uint8_t byteOffset;
+        uint8_t shift;
+        if (bitsPerPixel == 2) {
+            byteOffset = dx >> 2;
+            shift = 6 - ((dx & 0x3) << 1);
+        } else {
+            byteOffset = dx >> 1;
+            shift = ((dx & 0x1) == 0) ? 4 : 0;
+        }
+        const uint8_t *data = spriteData + startY*rowSize + byteOffset;
+        for (uint8_t dy = startY; dy < endY; ++dy) {
+            const uint8_t index = (pgm_read_byte(data) >> shift) & mask;
+            if (index != 0) {
+                if (blitMode == MeggyJr::BlitReplace) {
+                    ledMatrixSetPixel(column, y + dy, colors[index]);
+                } else {
+                    ledMatrixBlitPixel(column, y + dy, colors[index], blitMode);
+                }
+                if (fraction != 0) {
+                    fractionClearPixel(fraction, y + dy);
+                }
+            }
+            data += rowSize;
+        }
+        column += ledMatrixRowSize;
+        if (fraction != 0) {
+            fraction += highColorFractionRowSize;
+        }
+    }
+}
 
 // A matrix with for the 8 external LEDs
 uint8_t extLedMatrix;
+
+// The mask of the external LEDs with a brightness level between off and full.
+uint8_t extLedDimmedMask;
+
+// The brightness level for each dimmed external LED.
+uint8_t extLedLevels[8];
+
+// The bits of the dimmed external LEDs for each brightness level of the PWM driver.
+uint8_t extLedLevelBits[16];
+
+// The bits of the dimmed external LEDs for each bit plane of the BCM driver.
+uint8_t extLedPlaneBits[4];
+
+// The global brightness
+// ---------------------------------------------------------------------------
+
+// The maximum global brightness.
+const uint8_t maximumBrightness = 15;
+
+// The global brightness (0-15).
+volatile uint8_t displayBrightness;
+
+// The brightness to fade to.
+volatile uint8_t brightnessFadeTarget;
+
+// The number of frames for each step of the brightness fade.
+uint8_t brightnessFadeFrames;
+
+// The frame counter for the brightness fade.
+uint8_t brightnessFadeCounter;
+
+// The thresholds for the PWM driver. For each global brightness (rows) and
+// brightness level (columns), a LED is enabled if its value is above the
+// threshold. So a value v is shown in about v*brightness/15 of the levels.
+const uint8_t brightnessThresholds[16][16] PROGMEM = {
+    {15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15}, // 0
+    { 0, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15}, // 1
+    { 0,  7, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15}, // 2
+    { 0,  5, 10, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15}, // 3
+    { 0,  3,  7, 11, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15}, // 4
+    { 0,  3,  6,  9, 12, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15}, // 5
+    { 0,  2,  5,  7, 10, 12, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15}, // 6
+    { 0,  2,  4,  6,  8, 10, 12, 15, 15, 15, 15, 15, 15, 15, 15, 15}, // 7
+    { 0,  1,  3,  5,  7,  9, 11, 13, 15, 15, 15, 15, 15, 15, 15, 15}, // 8
+    { 0,  1,  3,  5,  6,  8, 10, 11, 13, 15, 15, 15, 15, 15, 15, 15}, // 9
+    { 0,  1,  3,  4,  6,  7,  9, 10, 12, 13, 15, 15, 15, 15, 15, 15}, // 10
+    { 0,  1,  2,  4,  5,  6,  8,  9, 10, 12, 13, 15, 15, 15, 15, 15}, // 11
+    { 0,  1,  2,  3,  5,  6,  7,  8, 10, 11, 12, 13, 15, 15, 15, 15}, // 12
+    { 0,  1,  2,  3,  4,  5,  6,  8,  9, 10, 11, 12, 13, 15, 15, 15}, // 13
+    { 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 15, 15}, // 14
+    { 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15}  // 15
+};
+
+// Get the factor for nibbleScale() for the global brightness.
+inline uint8_t brightnessScaleFactor()
+{
+    // Maps 0-15 to 0-16, close to brightness*16/15.
+    const uint8_t brightness = displayBrightness;
+    return brightness + (brightness >> 3);
+}
+
+// The extra LEDs
+// ---------------------------------------------------------------------------
+
+// Update the driver bits of one external LED for a brightness level.
+// Off and full on LEDs are in "extLedMatrix", so their level bits are cleared.
+static void extLedSetLevelBits(const uint8_t index, const uint8_t level)
+{
+    const uint8_t bit = _BV(index);
+    for (uint8_t cb = 0; cb < brightnessLevels; ++cb) {
+        if (level > cb && level < 15) {
+            extLedLevelBits[cb] |= bit;
+        } else {
+            extLedLevelBits[cb] &= ~bit;
+        }
+    }
+    for (uint8_t plane = 0; plane < bitPlanes; ++plane) {
+        if ((level & _BV(plane)) != 0 && level < 15) {
+            extLedPlaneBits[plane] |= bit;
+        } else {
+            extLedPlaneBits[plane] &= ~bit;
+        }
+    }
+}
+
+// Remove the brightness levels of all external LEDs.
+static void extLedClearLevels()
+{
+    if (extLedDimmedMask != 0) {
+        extLedDimmedMask = 0;
+        memset(extLedLevelBits, 0, sizeof(extLedLevelBits));
+        memset(extLedPlaneBits, 0, sizeof(extLedPlaneBits));
+    }
+}
+
+// Remove the brightness level of one external LED.
+static void extLedClearLevel(const uint8_t index)
+{
+    if ((extLedDimmedMask & _BV(index)) != 0) {
+        extLedDimmedMask &= ~_BV(index);
+        extLedSetLevelBits(index, 0);
+    }
+}
+
+// The high color mode
+// ---------------------------------------------------------------------------
+
+// The buffer for the high color mode, allocated in setup(). It contains
+// the dithered matrix which is displayed (96 bytes), the drawn fraction bits
+// (48 bytes) and the shown fraction bits (48 bytes). The upper 4 bits of
+// the shown colors are kept in the second led matrix buffer.
+//
+// The fraction bits are stored like the nibbles of the matrix, each byte
+// contains the 2 low bits for 4 nibbles. Bits 7-6 belong to the high
+// nibble of the first byte of a pair of matrix bytes.
+uint8_t *highColorBuffer;
+
+// The frame counter for the temporal dithering.
+uint8_t highColorPhase;
+
+// The order of the dithering thresholds. A fraction f adds one level
+// in f of 4 frames, this order spreads these frames evenly.
+const uint8_t highColorThreshold[4] = {0, 2, 1, 3};
+
+// Get the dithered matrix which is displayed.
+inline uint8_t* highColorDithered()
+{
+    return highColorBuffer;
+}
+
+// Get the fraction bits the application draws into.
+inline uint8_t* highColorFraction()
+{
+    return highColorBuffer + ledMatrixSize;
+}
+
+// Get the fraction bits which are shown.
+inline uint8_t* highColorShownFraction()
+{
+    return highColorBuffer + ledMatrixSize + highColorFractionSize;
+}
+
+// Get the upper 4 bits of the shown colors.
+inline uint8_t* highColorShownBase()
+{
+    return ledMatrixBuffers[ledMatrixIndex^1];
+}
+
+// Set the fraction bits of one pixel.
+// The three channels of a pixel are consecutive nibbles in the row.
+static void highColorSetFraction(const uint8_t x, const uint8_t y, const uint8_t red, const uint8_t green, const uint8_t blue)
+{
+    uint8_t *row = &highColorFraction()[x*highColorFractionRowSize];
+    uint8_t nibble = (y>>1)*6 + (y&1)*3;
+    const uint8_t values[3] = {red, green, blue};
+    for (uint8_t i = 0; i < 3; ++i) {
+        const uint8_t shift = 6 - ((nibble & 0x3) << 1);
+        uint8_t &bits = row[nibble >> 2];
+        bits = (bits & ~(0x3 << shift)) | ((values[i] & 0x3) << shift);
+        ++nibble;
+    }
+}
+
+// Get the fraction bits for drawing, or 0 without high color.
+inline uint8_t* highColorDrawFraction()
+{
+    return (highColorBuffer != 0) ? highColorFraction() : 0;
+}
+
+// Clear the fraction bits of a rectangle after drawing 4 bit colors into
+// it, so the dithering does not add the fractions of earlier pixels.
+static void highColorClearFraction(const uint8_t x, const uint8_t y, const uint8_t width, const uint8_t height)
+{
+    if (highColorBuffer == 0) {
+        return;
+    }
+    uint8_t *row = &highColorFraction()[x*highColorFractionRowSize];
+    for (uint8_t i = 0; i < width; ++i) {
+        if (y == 0 && height == numberOfRows) {
+            memset(row, 0, highColorFractionRowSize);
+        } else {
+            for (uint8_t dy = 0; dy < height; ++dy) {
+                fractionClearPixel(row, y + dy);
+            }
+        }
+        row += highColorFractionRowSize;
+    }
+}
+
+// Clear all fraction bits, after the whole matrix is changed.
+inline void highColorClearAllFractions()
+{
+    if (highColorBuffer != 0) {
+        memset(highColorFraction(), 0, highColorFractionSize);
+    }
+}
+
+// Scroll the fraction bits together with the pixels. Each pixel has 6
+// bits in a row, scrolling up and down rotates the rows one bit at a time.
+static void highColorScrollFraction(const uint8_t scrollDirection)
+{
+    if (highColorBuffer == 0) {
+        return;
+    }
+    uint8_t * const fraction = highColorFraction();
+    const uint8_t lastRow = (numberOfRows - 1)*highColorFractionRowSize;
+    uint8_t bits[highColorFractionRowSize];
+    switch (scrollDirection) {
+        case MeggyJr::ScrollLeft:
+            memcpy(bits, fraction, highColorFractionRowSize);
+            memmove(fraction, fraction + highColorFractionRowSize, lastRow);
+            memcpy(fraction + lastRow, bits, highColorFractionRowSize);
+            break;
+
+        case MeggyJr::ScrollRight:
+            memcpy(bits, fraction + lastRow, highColorFractionRowSize);
+            memmove(fraction + highColorFractionRowSize, fraction, lastRow);
+            memcpy(fraction, bits, highColorFractionRowSize);
+            break;
+
+        case MeggyJr::ScrollUp:
+            for (uint8_t *row = fraction; row < fraction + highColorFractionSize; row += highColorFractionRowSize) {
+                for (uint8_t n = 0; n < 6; ++n) {
+                    const uint8_t carry = row[0] >> 7;
+                    for (uint8_t i = 0; i < highColorFractionRowSize - 1; ++i) {
+                        row[i] = (row[i] << 1) | (row[i+1] >> 7);
+                    }
+                    row[highColorFractionRowSize - 1] = (row[highColorFractionRowSize - 1] << 1) | carry;
+                }
+            }
+            break;
+
+        case MeggyJr::ScrollDown:
+            for (uint8_t *row = fraction; row < fraction + highColorFractionSize; row += highColorFractionRowSize) {
+                for (uint8_t n = 0; n < 6; ++n) {
+                    const uint8_t carry = row[highColorFractionRowSize - 1] << 7;
+                    for (uint8_t i = highColorFractionRowSize - 1; i > 0; --i) {
+                        row[i] = (row[i] >> 1) | (row[i-1] << 7);
+                    }
+                    row[0] = (row[0] >> 1) | carry;
+                }
+            }
+            break;
+    }
+}
+
+// The mono layer
+// ---------------------------------------------------------------------------
+
+// The mono layer the application draws into, in the row format of the
+// driver: one byte for each x position, bit 7 is the topmost pixel.
+// Drawing stores the bits in this order, so the driver just copies them.
+uint8_t monoLayer[numberOfRows];
+
+// The shown mono layer.
+uint8_t monoLayerShown[numberOfRows];
+
+// The flag if the mono layer was changed since it was taken.
+volatile bool monoLayerChanged;
+
+// The color for the mono layer.
+uint8_t monoRed;
+uint8_t monoGreen;
+uint8_t monoBlue;
+
+// The color correction
+// ---------------------------------------------------------------------------
+
+// The lookup tables for the red, green and blue channel.
+uint8_t colorCorrection[3][16];
+
+// The flag if the color correction is applied.
+volatile bool colorCorrectionEnabled;
+
+// A gamma curve of 2.2 for the 16 levels, scaled to 0-255.
+const uint8_t colorGammaCurve[16] PROGMEM = {
+    0, 1, 3, 7, 14, 23, 34, 48, 64, 83, 105, 129, 156, 186, 219, 255
+};
     
 // Required variables for the LED driver
 // ---------------------------------------------------------------------------
 
+// The selected display options.
+uint8_t activeDisplayOptions;
+
+// Check if the "ledMatrix" contains colors. In palette mode it contains
+// the index image and the palette, so all color methods do nothing.
+inline bool ledMatrixHasColors()
+{
+    return (activeDisplayOptions & MeggyJr::DisplayPalette) == 0;
+}
+
 // The current driven row
 uint8_t drivenRow;
 
 // The current brightnes value
 uint8_t drivenBrightness;
+
+// The current bit plane for the BCM driver.
+uint8_t drivenBitPlane;
+
+// The flag if the PWM driver takes the rows of a presented frame in palette
+// or high color mode. It is set at the last brightness level of row 0.
+bool drivenTakeRows;
     
 // The next bits for the row.
 uint8_t drivenBits[3];
@@ -151,6 +739,14 @@ const uint8_t drivenRowPortB[numberOfRows] PROGMEM = {
     B11111111,    
 };
 
+// The timer TOP values for the weighted time slots of the BCM driver.
+const uint8_t drivenSlotTop[bitPlanes] PROGMEM = {
+    bcmSlotUnit*1-1,
+    bcmSlotUnit*2-1,
+    bcmSlotUnit*4-1,
+    bcmSlotUnit*8-1,
+};
+
 // The application frame values
 // ---------------------------------------------------------------------------
 
@@ -162,19 +758,116 @@ uint32_t applicationFrame;
 
 // The flag for frame synchronization.
 volatile uint8_t applicationFrameSync;
+
+// The value of "applicationFrameSync" at the last frame the application consumed.
+uint8_t applicationFrameSyncSeen;
+
+// The flag if the pixels were prepared for the next frame by pollFrame().
+bool applicationFramePrepared;
+
+// The callback which is called while waiting for the frame synchronization, or 0.
+MeggyJr::IdleCallback applicationIdleCallback;
+
+// The frame number at the last frame the application consumed, 0 before the first frame.
+uint32_t applicationLastFrame;
+
+// The number of frames which passed between the last two consumed frames.
+uint8_t applicationElapsedFrames;
+
+// The total number of frames the application missed.
+uint32_t applicationMissedFrames;
+
+// The highest number of frames missed at once.
+uint8_t applicationWorstOverrun;
+
+// The number of buckets of the load histogram.
+const uint8_t loadHistogramSize = 16;
+
+// The histogram of the frame load, each bucket is 1/15 of the frame duration.
+// The last bucket counts the frames which took longer than the frame duration.
+uint16_t loadHistogram[loadHistogramSize];
+
+// The longest measured frame time in Timer2 counts.
+uint32_t loadWorstFrameCounts;
+
+// The frame number of the frame with the longest frame time.
+uint32_t loadWorstFrame;
+
+// The flag if the start of the current frame was stored by the frame sync.
+bool loadFrameStarted;
+
+// The flag if the application sleeps while waiting for the frame synchronization.
+bool applicationIdleSleep;
+
+// The Timer2 counts the application slept while waiting for the current frame.
+uint32_t applicationSleepCounts;
+
+// The Timer2 counts the application slept while waiting for the last frame.
+uint32_t applicationLastSleepCounts;
+
+// The Timer2 counts of all completed display periods, wraps around.
+volatile uint32_t displayCounts;
+
+// The Timer2 counts spent in the display interrupt, wraps around.
+volatile uint32_t displayInterruptCounts;
+
+// The Timer2 counts of the longest display interrupt.
+volatile uint16_t displayLongestInterrupt;
+
+// The flag if the time spent in the display interrupt is measured.
+// It is not reset in setup(), so it can be enabled by global objects.
+volatile bool displayMeasureInterrupts;
+
+// The shift to convert Timer2 counts into CPU cycles (the prescaler).
+uint8_t displayTimerShift;
+
+// The flag if the application requested to present the "ledMatrix".
+volatile bool applicationPresentRequest;
+
+// The flag if the "ledMatrix" was presented with the last application frame.
+volatile bool applicationFramePresented;
+    
+// The Timer2 timestamp of the last frame sync, to measure the load.
+uint32_t applicationFrameStartCounts;
+
+// The Timer2 counts of an application frame.
+uint32_t applicationFrameCounts;
+
+    
+// Variables for the stack measurement
+// ---------------------------------------------------------------------------
+
+// The value used to paint the unused stack.
+const uint8_t stackPaintPattern = 0xC5;
+
+// The number of bytes checked at each frame sync.
+const uint8_t stackScanBytesPerFrame = 16;
+
+// The distance to the stack pointer which is not painted.
+const uint8_t stackPaintMargin = 32;
+
+// The first painted byte, at the end of the heap.
+uint8_t *stackPaintStart;
+
+// The lowest byte found in use. All painted bytes below are unused.
+uint8_t *stackLowestUsed;
+
+// The next byte to check.
+uint8_t *stackScanPointer;
+
     
-// The last measured time in microseconds to measure the load
-uint32_t applicationFrameSyncLastTime;
+// Variables for the canvas
+// ---------------------------------------------------------------------------
+
+// The canvas which is shown, or 0 if there is no canvas.
+const Canvas *viewportCanvas;
 
-// The measured time for an application frame
-uint32_t applicationFrameDuration;
+// The position of the viewport in the canvas.
+int16_t viewportX;
+int16_t viewportY;
 
-// The state of the measurement process.
-enum ApplicationFrameMeasureState : uint8_t {
-    ApplicationFrameMeasure_Uninitialized,
-    ApplicationFrameMeasure_LastTime,
-    ApplicationFrameMeasure_Ready
-} applicationFrameMeasureState;
+// The flag if the viewport wraps around at the edges of the canvas.
+bool viewportWrap;
 
     
 // Variables for the sound player.
@@ -481,35 +1174,274 @@ static void soundDriver()
 }
 
     
-// The LED Driver
+// The Canvas
 // ----------------------------------------------------------------------------
 
-    
-// Turn the complete display off.
-static void displayOff()
+
+// Limit or wrap a viewport position.
+static int16_t viewportLimit(int16_t position, const uint8_t canvasSize)
 {
-    PORTD |= B11111100;
-    PORTB |= B00010001;
+    if (viewportWrap) {
+        position %= canvasSize;
+        if (position < 0) {
+            position += canvasSize;
+        }
+    } else {
+        const int16_t maximum = (int16_t)canvasSize - numberOfRows;
+        if (position > maximum) {
+            position = maximum;
+        }
+        if (position < 0) {
+            position = 0;
+        }
+    }
+    return position;
 }
 
 
-// The setup method for the LED driver.
-static void ledDriverSetup()
+// Get the Timer2 counts since the setup, including the current display period.
+static uint32_t displayTimestamp()
 {
-    // Start with row 0 and brightnesss 0;
-    drivenRow = 0;
+    const uint8_t oldSREG = SREG;
+    cli();
+    uint8_t count = TCNT2;
+    uint32_t counts = displayCounts;
+    if ((TIFR2 & _BV(OCF2A)) != 0) {
+        // The period ended, but the interrupt did not run yet.
+        count = TCNT2;
+        counts += (uint8_t)(OCR2A + 1);
+    }
+    SREG = oldSREG;
+    return counts + count;
+}
+
+    
+// Convert Timer2 counts into microseconds.
+static uint32_t displayCountsToMicroseconds(const uint32_t counts)
+{
+    return (counts << displayTimerShift) / (F_CPU / 1000000);
+}
+
+    
+// Paint the unused memory between the heap and the stack.
+static void stackPaint()
+{
+    uint8_t marker;
+    stackPaintStart = (__brkval == 0) ? (uint8_t*)&__heap_start : (uint8_t*)__brkval;
+    uint8_t *paintEnd = &marker - stackPaintMargin;
+    for (uint8_t *p = stackPaintStart; p < paintEnd; ++p) {
+        *p = stackPaintPattern;
+    }
+    stackLowestUsed = paintEnd;
+    stackScanPointer = stackPaintStart;
+}
+
+    
+// Check the next few painted bytes for the lowest used byte.
+// The scan runs from the bottom, so the first changed byte is the lowest.
+static void stackScanStep()
+{
+    for (uint8_t i = 0; i < stackScanBytesPerFrame; ++i) {
+        if (stackScanPointer >= stackLowestUsed) {
+            stackScanPointer = stackPaintStart;
+            return;
+        }
+        if (*stackScanPointer != stackPaintPattern) {
+            stackLowestUsed = stackScanPointer;
+            stackScanPointer = stackPaintStart;
+            return;
+        }
+        ++stackScanPointer;
+    }
+}
+
+    
+// Get the extra LEDs to show the given free memory.
+static uint8_t freeMemoryLeds(const int freeMemory)
+{
+    if (freeMemory < 0) {
+        return B11110000;
+    } else if (freeMemory < 256) {
+        const uint16_t load = freeMemory/32;
+        return ((uint16_t)1 << load)-1;
+    } else {
+        return B11111111;
+    }
+}
+
+    
+// Mark the current frame as consumed by the application and count missed frames.
+static void applicationConsumeFrame()
+{
+    applicationFrameSyncSeen = applicationFrameSync;
+    applicationFramePrepared = false;
+    const uint32_t frame = applicationFrame;
+    if (applicationLastFrame != 0) {
+        const uint32_t elapsed = frame - applicationLastFrame;
+        applicationElapsedFrames = (elapsed > 0xFF) ? 0xFF : elapsed;
+        if (applicationElapsedFrames > 1) {
+            const uint8_t missed = applicationElapsedFrames - 1;
+            applicationMissedFrames += missed;
+            if (missed > applicationWorstOverrun) {
+                applicationWorstOverrun = missed;
+            }
+        }
+    }
+    applicationLastFrame = frame;
+    applicationFrameStartCounts = displayTimestamp();
+    loadFrameStarted = true;
+    stackScanStep();
+}
+
+    
+// Add the time used since the last frame sync to the load histogram.
+static void applicationRecordLoad()
+{
+    if (!loadFrameStarted) {
+        return;
+    }
+    loadFrameStarted = false;
+    const uint32_t frameCounts = displayTimestamp() - applicationFrameStartCounts;
+    uint32_t bucket = frameCounts * (loadHistogramSize - 1) / applicationFrameCounts;
+    if (bucket >= loadHistogramSize) {
+        bucket = loadHistogramSize - 1;
+    }
+    if (loadHistogram[bucket] < 0xFFFF) {
+        ++loadHistogram[bucket];
+    }
+    if (frameCounts > loadWorstFrameCounts) {
+        loadWorstFrameCounts = frameCounts;
+        loadWorstFrame = applicationLastFrame;
+    }
+}
+
+    
+// Sleep until the next interrupt and add the time asleep to "applicationSleepCounts".
+// The display interrupt wakes the CPU at the latest after one display period.
+// The time spent in the display interrupt is not measured as sleep.
+// The frame sync value is checked with disabled interrupts, so the CPU never
+// sleeps after the frame for which the application waits was signalled.
+static void applicationSleep(const uint8_t lastValue)
+{
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    cli();
+    if (applicationFrameSync != lastValue) {
+        sei();
+        return;
+    }
+    // Measure the interrupts while sleeping, even if it is disabled.
+    const bool measureInterrupts = displayMeasureInterrupts;
+    displayMeasureInterrupts = true;
+    const uint32_t startCounts = displayTimestamp();
+    const uint32_t startInterruptCounts = displayInterruptCounts;
+    sleep_enable();
+    sei(); // The instruction after sei is executed before any interrupt.
+    sleep_cpu();
+    sleep_disable();
+    cli();
+    const uint32_t counts = displayTimestamp() - startCounts;
+    const uint32_t interruptCounts = displayInterruptCounts - startInterruptCounts;
+    displayMeasureInterrupts = measureInterrupts;
+    sei();
+    if (counts > interruptCounts) {
+        applicationSleepCounts += counts - interruptCounts;
+    }
+}
+
+    
+// Prepare the "ledMatrix" before it is presented.
+static void presentPrepare()
+{
+    if (viewportCanvas != 0 && (activeDisplayOptions & MeggyJr::DisplayPalette) == 0) {
+        viewportCanvas->render(viewportX, viewportY, viewportWrap, ledMatrix());
+        highColorClearAllFractions();
+    }
+}
+
+    
+// The LED Driver
+// ----------------------------------------------------------------------------
+
+    
+// Turn the complete display off.
+static void displayOff()
+{
+    PORTD |= B11111100;
+    PORTB |= B00010001;
+}
+
+
+// The setup method for the LED driver.
+static void ledDriverSetup()
+{
+    // Start with row 0 and brightnesss 0;
+    drivenRow = 0;
     drivenBrightness = 0;
+    drivenBitPlane = 0;
     drivenBits[0] = 0;
     drivenBits[1] = 0;
     drivenBits[2] = 0;
     
-    // Start with a black frame.
+    // Start with a black frame and a white mono layer.
+    memset(monoLayerShown, 0, numberOfRows);
+    monoRed = 14;
+    monoGreen = 4;
+    monoBlue = 2;
+    colorCorrectionEnabled = false;
+    displayBrightness = maximumBrightness;
+    brightnessFadeTarget = maximumBrightness;
+    brightnessFadeFrames = 1;
+    brightnessFadeCounter = 0;
+    displayedLedMatrix = ledMatrixBuffers[ledMatrixIndex^1];
     for (uint8_t i = 0; i < ledMatrixSize; ++i) {
         displayedLedMatrix[i] = 0x00;
     }
     
+    // In high color mode, the dithered matrix is displayed.
+    highColorPhase = 0;
+    if ((activeDisplayOptions & MeggyJr::DisplayHighColor) != 0) {
+        displayedLedMatrix = highColorDithered();
+        memset(displayedLedMatrix, 0, ledMatrixSize);
+        memset(highColorShownFraction(), 0, highColorFractionSize);
+    }
+    
     // set the driven frame to 0
     drivenFrame = 0;
+    drivenTakeRows = false;
+}
+
+    
+// Take the mono layer, which is already in the row format of the driver.
+// This is only done if the mono layer was changed, and only for presented
+// frames, so the layer and the pixels are always shown together.
+static void ledDriverMonoTake()
+{
+    if (!monoLayerChanged) {
+        return;
+    }
+    monoLayerChanged = false;
+    memcpy(monoLayerShown, monoLayer, numberOfRows);
+}
+
+
+// Draw the mono layer over the calculated bits of a row.
+static inline void ledDriverMonoRow(const uint8_t row, const uint8_t cb, uint8_t &r, uint8_t &g, uint8_t &b)
+{
+    const uint8_t mask = monoLayerShown[row];
+    if (mask != 0) {
+        r &= ~mask;
+        g &= ~mask;
+        b &= ~mask;
+        if (monoRed > cb) {
+            r |= mask;
+        }
+        if (monoGreen > cb) {
+            g |= mask;
+        }
+        if (monoBlue > cb) {
+            b |= mask;
+        }
+    }
 }
 
     
@@ -597,7 +1529,7 @@ static void ledDriverCopyDisplay()
     "dec r16"                    "\n\t"
     "brne L_l4%="                "\n\t"
     :
-    : [src] "x" (ledMatrix), [dst] "y" (displayedLedMatrix), [db] "z" (drivenBits), [spi] "I" (_SFR_IO_ADDR(SPDR))
+    : [src] "x" (ledMatrix()), [dst] "y" (displayedLedMatrix), [db] "z" (drivenBits), [spi] "I" (_SFR_IO_ADDR(SPDR))
     : "r16"
     );
     
@@ -630,6 +1562,9 @@ static void ledDriverCopyDisplay()
         cb &= brightnessLevelsMask;
     }
     
+    // Map the level to the threshold for the global brightness.
+    cb = pgm_read_byte(&brightnessThresholds[displayBrightness][cb]);
+    
     asm volatile(
                 
     "ldd r16, %a[lm]+0" "\n\t"
@@ -757,6 +1692,9 @@ static void ledDriverCopyDisplay()
     : "r16", "r17"
     );
     
+    // Draw the mono layer over the row.
+    ledDriverMonoRow((drivenRow+1)&numberOfRowMask, cb, r, g, b);
+    
     // Store the calculated bits for the next row:
     drivenBits[0] = r;
     drivenBits[1] = g;
@@ -764,6 +1702,15 @@ static void ledDriverCopyDisplay()
 }
 
     
+// This flips the "ledMatrix" and the "displayLedMatrix".
+// The application continues drawing into the previously displayed matrix.
+static void ledDriverFlipDisplay()
+{
+    displayedLedMatrix = ledMatrix();
+    ledMatrixIndex ^= 1;
+}
+
+    
 // This displays a normal row. And precalculates the bits for the next row.
 static void ledDriverNormalRow()
 {
@@ -780,6 +1727,9 @@ static void ledDriverNormalRow()
         cb &= brightnessLevelsMask;
     }
     
+    // Map the level to the threshold for the global brightness.
+    cb = pgm_read_byte(&brightnessThresholds[displayBrightness][cb]);
+    
     // Enable SPI (SPE) in master mode (MSTR).
     SPCR = _BV(SPE)|_BV(MSTR);
     
@@ -790,7 +1740,7 @@ static void ledDriverNormalRow()
     
     // Send first byte. First byte is the external LED.
     if (drivenRow == 0) {
-        SPDR = extLedMatrix;
+        SPDR = extLedMatrix | extLedLevelBits[drivenBrightness];
     } else {
         SPDR = B00000000;
     }
@@ -945,54 +1895,245 @@ static void ledDriverNormalRow()
     // Turn SPI off
     SPCR = B00000000;
     
+    // Turn the correct row on
+    PORTD &= pgm_read_byte(&drivenRowPortD[drivenRow]);
+    PORTB &= pgm_read_byte(&drivenRowPortB[drivenRow]);
+
+    // Draw the mono layer over the next row.
+    ledDriverMonoRow((drivenRow+1)&numberOfRowMask, cb, r, g, b);
+    
     // Store the calculated bits for the next row:
     drivenBits[0] = r;
     drivenBits[1] = g;
     drivenBits[2] = b;
-
-    // Turn the correct row on
-    PORTD &= pgm_read_byte(&drivenRowPortD[drivenRow]);
-    PORTB &= pgm_read_byte(&drivenRowPortB[drivenRow]);
 }
     
     
-// The LED driver.
-static void ledDriver()
+// Apply the color correction to one row in the packed format.
+// Each byte contains two channels in the order RG BR GB.
+static void ledDriverCorrectRow(const uint8_t *src, uint8_t *dst)
 {
-    // Turn the display off, because column bits get shifted.
-    displayOff();
+    const uint8_t *red = colorCorrection[0];
+    const uint8_t *green = colorCorrection[1];
+    const uint8_t *blue = colorCorrection[2];
+    for (uint8_t i = 0; i < (ledMatrixRowSize/3); ++i) {
+        const uint8_t rg = src[0];
+        const uint8_t br = src[1];
+        const uint8_t gb = src[2];
+        dst[0] = (red[rg >> 4] << 4) | green[rg & 0x0F];
+        dst[1] = (blue[br >> 4] << 4) | red[br & 0x0F];
+        dst[2] = (green[gb >> 4] << 4) | blue[gb & 0x0F];
+        src += 3;
+        dst += 3;
+    }
+}
+
+
+// Dither one row of the high color mode into the "displayedLedMatrix".
+// Each nibble is increased by one, if its fraction is above the threshold
+// for this frame. The threshold is shifted for each row, to avoid flicker
+// of large areas.
+static void ledDriverHighColorRow(const uint8_t row, const uint8_t phase)
+{
+    const uint8_t *base = &highColorShownBase()[row*ledMatrixRowSize];
+    const uint8_t *fraction = &highColorShownFraction()[row*highColorFractionRowSize];
+    uint8_t *dst = &displayedLedMatrix[row*ledMatrixRowSize];
+    const uint8_t threshold = highColorThreshold[(phase + row) & 0x3];
+    for (uint8_t i = 0; i < (ledMatrixRowSize/2); ++i) {
+        uint8_t bits = fraction[i];
+        for (uint8_t j = 0; j < 2; ++j) {
+            uint8_t value = *base++;
+            if (((bits >> 6) & 0x3) > threshold && (value & 0xF0) != 0xF0) {
+                value += 0x10;
+            }
+            if (((bits >> 4) & 0x3) > threshold && (value & 0x0F) != 0x0F) {
+                value += 0x01;
+            }
+            *dst++ = value;
+            bits <<= 4;
+        }
+    }
+}
+
+
+// Apply the color correction to a single color.
+inline uint16_t ledDriverCorrectColor(const uint16_t c)
+{
+    return ((uint16_t)colorCorrection[0][(c >> 8) & 0x0F] << 8) |
+        (colorCorrection[1][(c >> 4) & 0x0F] << 4) |
+        colorCorrection[2][c & 0x0F];
+}
+
+
+// Get the colors of the palette for this frame.
+// The color correction is applied to the 16 colors, not to the pixels.
+static void ledDriverPaletteColors(uint16_t *colors)
+{
+    const uint16_t *source = palette();
+    if (colorCorrectionEnabled) {
+        for (uint8_t i = 0; i < 16; ++i) {
+            colors[i] = ledDriverCorrectColor(source[i]);
+        }
+    } else {
+        memcpy(colors, source, sizeof(uint16_t)*16);
+    }
+}
     
+    
+// Resolve one row of the drawn index image into the packed format.
+// If "correct" is set, the color correction is applied to each pixel.
+static void ledDriverPaletteResolveRow(const uint8_t row, const uint16_t *colors, const bool correct, uint8_t *dst)
+{
+    const uint8_t *src = &paletteImage()[row*paletteImageRowSize];
+    for (uint8_t i = 0; i < paletteImageRowSize; ++i) {
+        const uint8_t indexes = src[i];
+        uint16_t c0 = colors[indexes >> 4];
+        uint16_t c1 = colors[indexes & 0x0F];
+        if (correct) {
+            c0 = ledDriverCorrectColor(c0);
+            c1 = ledDriverCorrectColor(c1);
+        }
+        dst[0] = c0 >> 4;
+        dst[1] = ((c0 << 4) & 0xFF) | (c1 >> 8);
+        dst[2] = c1 & 0xFF;
+        dst += 3;
+    }
+}
+
+
+// Check if the "ledMatrix" has to be presented with this application frame.
+// Without the explicit present option, every frame is presented.
+static bool ledDriverCheckPresent()
+{
+    bool present = true;
+    if ((activeDisplayOptions & MeggyJr::DisplayExplicitPresent) != 0) {
+        present = applicationPresentRequest;
+        applicationPresentRequest = false;
+    }
+    applicationFramePresented = present;
+    return present;
+}
+
+
+// Check if the PWM driver prepares the rows one by one. This is done in
+// palette and high color mode, and for the color correction without page flip.
+static inline bool ledDriverTakesRows()
+{
+    return (activeDisplayOptions & (MeggyJr::DisplayPalette|MeggyJr::DisplayHighColor)) != 0 ||
+        (colorCorrectionEnabled && (activeDisplayOptions & MeggyJr::DisplayPageFlip) == 0);
+}
+
+
+// Prepare a row of the PWM driver for the next frame, at its last brightness
+// level. The LEDs are all off at brightness 15 and the row is not read again
+// in this frame, so the rows are prepared one by one without a visible change,
+// and no tick has to prepare all rows. At the last brightness level of row 0,
+// the driver decides if the frame is presented. In palette mode, a presented
+// row is resolved. In high color mode, a presented row is taken, and each row
+// is dithered for every frame. Otherwise a presented row is copied with the
+// color correction.
+static void ledDriverTakeRow()
+{
+    if (drivenRow == 0 && drivenFrame + 1 >= applicationFrameRate) {
+        drivenTakeRows = ledDriverCheckPresent();
+    }
+    if ((activeDisplayOptions & MeggyJr::DisplayPalette) != 0) {
+        if (drivenTakeRows) {
+            ledDriverPaletteResolveRow(drivenRow, palette(), colorCorrectionEnabled, &displayedLedMatrix[drivenRow*ledMatrixRowSize]);
+        }
+    } else if ((activeDisplayOptions & MeggyJr::DisplayHighColor) != 0) {
+        if (drivenTakeRows) {
+            memcpy(&highColorShownBase()[drivenRow*ledMatrixRowSize], &ledMatrix()[drivenRow*ledMatrixRowSize], ledMatrixRowSize);
+            memcpy(&highColorShownFraction()[drivenRow*highColorFractionRowSize], &highColorFraction()[drivenRow*highColorFractionRowSize], highColorFractionRowSize);
+        }
+        ledDriverHighColorRow(drivenRow, highColorPhase+1);
+        if (drivenRow == (numberOfRows-1)) {
+            ++highColorPhase;
+        }
+    } else if (drivenTakeRows) {
+        ledDriverCorrectRow(&ledMatrix()[drivenRow*ledMatrixRowSize], &displayedLedMatrix[drivenRow*ledMatrixRowSize]);
+    }
+}
+
+
+// Signal a new application frame.
+// This is called after the "ledMatrix" was copied into the "displayedLedMatrix".
+// (or both were flipped)
+static void ledDriverSignalFrame()
+{
+    drivenFrame = 0;
+    ++applicationFrame;
+    // signal the frame sync.
+    ++applicationFrameSync;
+    // Fade the global brightness.
+    if (displayBrightness != brightnessFadeTarget && ++brightnessFadeCounter >= brightnessFadeFrames) {
+        brightnessFadeCounter = 0;
+        if (displayBrightness < brightnessFadeTarget) {
+            ++displayBrightness;
+        } else {
+            --displayBrightness;
+        }
+    }
+    // Manage the button states
+    buttonLastState = buttonCurrentState;
+    buttonCurrentState = (~(PINC) & B00111111);
+}
+
+
+// The PWM LED driver, called 16 times for each row and frame.
+static void ledDriverPWM()
+{
     // For the last row, after a complete brigthness loop, a
     // special handling is performed. Depending on the application
-    // frame rate, the "ledMatrix" is copied into the "displayMatrix".
+    // frame rate, the "ledMatrix" is copied into the "displayMatrix",
+    // or both matrixes are flipped.
     
     if (drivenRow == (numberOfRows-1) && drivenBrightness == (brightnessLevels-1)) {
+        // Prepare the last row, if the rows are prepared one by one.
+        const bool takeRows = ledDriverTakesRows();
+        if (takeRows) {
+            ledDriverTakeRow();
+        }
         // Manage the application frame.
         if (++drivenFrame >= applicationFrameRate) {
-            // The special case where we copy the "ledMatrix".
-            ledDriverCopyDisplay();
-            drivenFrame = 0;
-            ++applicationFrame;
-            // signal the frame sync.
-            ++applicationFrameSync;
-            // see if we have to measure a frame
-            if (applicationFrameMeasureState == ApplicationFrameMeasure_Uninitialized) {
-                applicationFrameSyncLastTime = micros();
-                applicationFrameMeasureState = ApplicationFrameMeasure_LastTime;
-            } else if (applicationFrameMeasureState == ApplicationFrameMeasure_LastTime) {
-                applicationFrameDuration = micros() - applicationFrameSyncLastTime;
-                applicationFrameSyncLastTime = micros();
-                applicationFrameMeasureState = ApplicationFrameMeasure_Ready;
+            bool present;
+            if (takeRows) {
+                // Decided at the start of the last brightness level.
+                present = drivenTakeRows;
+                applicationFramePresented = present;
+            } else {
+                present = ledDriverCheckPresent();
+            }
+            drivenTakeRows = false;
+            if (present) {
+                ledDriverMonoTake();
             }
-            // Manage the button states
-            buttonLastState = buttonCurrentState;
-            buttonCurrentState = (~(PINC) & B00111111);
+            if (takeRows) {
+                // All rows are already prepared in the "displayMatrix".
+                ledDriverNormalRow();
+            } else if (!present) {
+                // Nothing new to present, keep the displayed matrix.
+                ledDriverNormalRow();
+            } else if ((activeDisplayOptions & MeggyJr::DisplayPageFlip) != 0) {
+                // Flip the matrixes, this is as fast as a normal row.
+                ledDriverFlipDisplay();
+                ledDriverNormalRow();
+            } else {
+                // The special case where we copy the "ledMatrix".
+                ledDriverCopyDisplay();
+            }
+            ledDriverSignalFrame();
         } else {
             ledDriverNormalRow();
         }
     } else {
         // the regular case.
         ledDriverNormalRow();
+        // If the rows are prepared one by one, a row is prepared for the
+        // next frame after its last brightness level.
+        if (drivenBrightness == (brightnessLevels-1) && ledDriverTakesRows()) {
+            ledDriverTakeRow();
+        }
     }
 
     // Call the sound driver at 1.92kHz.
@@ -1011,6 +2152,273 @@ static void ledDriver()
     ++drivenRow;
     drivenRow &= numberOfRowMask; // limit to 8 rows.
 }
+
+
+// Send one byte using SPI and wait until it is sent.
+static inline void ledDriverSend(const uint8_t value)
+{
+    SPDR = value;
+    while ((SPSR & _BV(SPIF)) == 0) {}
+}
+
+    
+// This displays the bit plane for the current BCM time slot.
+static void ledDriverBCMShowSlot()
+{
+    // The length of the time slot depends on the bit plane. The
+    // timer was just reset, so the new TOP is used for this slot.
+    OCR2A = pgm_read_byte(&drivenSlotTop[drivenBitPlane]);
+    
+    // A pointer to the bit plane of the row.
+    const uint8_t *plane = &displayedLedMatrix[drivenRow*ledMatrixRowSize+drivenBitPlane*3];
+    
+    // Enable SPI (SPE) in master mode (MSTR).
+    SPCR = _BV(SPE)|_BV(MSTR);
+    
+    // Send first byte. First byte is the external LED.
+    if (drivenRow == 0) {
+        ledDriverSend(extLedMatrix | extLedPlaneBits[drivenBitPlane]);
+    } else {
+        ledDriverSend(B00000000);
+    }
+    ledDriverSend(plane[0]);
+    ledDriverSend(plane[1]);
+    ledDriverSend(plane[2]);
+    
+    // Latch pulse
+    PORTB |= _BV(2);
+    PORTB &= ~_BV(2);
+    
+    // Turn SPI off
+    SPCR = B00000000;
+
+    // Turn the correct row on
+    PORTD &= pgm_read_byte(&drivenRowPortD[drivenRow]);
+    PORTB &= pgm_read_byte(&drivenRowPortB[drivenRow]);
+}
+
+
+// This slices one row in the packed format into its bit planes.
+//
+// Each nibble is shifted out bit by bit, and each bit is shifted into the
+// byte of its plane. After 4 groups of 3 bytes, each of the 12 plane bytes
+// got 8 bits, so the registers don't have to be cleared.
+static void ledDriverBCMSliceRow(const uint8_t *src, uint8_t *dst)
+{
+    asm volatile(
+    
+    "ldi r17, 4"          "\n"
+    "L_sp1%=: "
+    
+    // Byte format RG: low nibble green, high nibble red.
+    "ld r16, %a[src]+"    "\n\t"
+    "lsr r16"             "\n\t"
+    "rol r3"              "\n\t"
+    "lsr r16"             "\n\t"
+    "rol r6"              "\n\t"
+    "lsr r16"             "\n\t"
+    "rol r9"              "\n\t"
+    "lsr r16"             "\n\t"
+    "rol r12"             "\n\t"
+    "lsr r16"             "\n\t"
+    "rol r2"              "\n\t"
+    "lsr r16"             "\n\t"
+    "rol r5"              "\n\t"
+    "lsr r16"             "\n\t"
+    "rol r8"              "\n\t"
+    "lsr r16"             "\n\t"
+    "rol r11"             "\n\t"
+    
+    // Byte format BR: low nibble red, high nibble blue.
+    "ld r16, %a[src]+"    "\n\t"
+    "lsr r16"             "\n\t"
+    "rol r2"              "\n\t"
+    "lsr r16"             "\n\t"
+    "rol r5"              "\n\t"
+    "lsr r16"             "\n\t"
+    "rol r8"              "\n\t"
+    "lsr r16"             "\n\t"
+    "rol r11"             "\n\t"
+    "lsr r16"             "\n\t"
+    "rol r4"              "\n\t"
+    "lsr r16"             "\n\t"
+    "rol r7"              "\n\t"
+    "lsr r16"             "\n\t"
+    "rol r10"             "\n\t"
+    "lsr r16"             "\n\t"
+    "rol r13"             "\n\t"
+    
+    // Byte format GB: low nibble blue, high nibble green.
+    "ld r16, %a[src]+"    "\n\t"
+    "lsr r16"             "\n\t"
+    "rol r4"              "\n\t"
+    "lsr r16"             "\n\t"
+    "rol r7"              "\n\t"
+    "lsr r16"             "\n\t"
+    "rol r10"             "\n\t"
+    "lsr r16"             "\n\t"
+    "rol r13"             "\n\t"
+    "lsr r16"             "\n\t"
+    "rol r3"              "\n\t"
+    "lsr r16"             "\n\t"
+    "rol r6"              "\n\t"
+    "lsr r16"             "\n\t"
+    "rol r9"              "\n\t"
+    "lsr r16"             "\n\t"
+    "rol r12"             "\n\t"
+    
+    "dec r17"             "\n\t"
+    "brne L_sp1%="        "\n\t"
+    
+    // Store the planes R0 G0 B0 ... R3 G3 B3
+    "st %a[dst]+, r2"     "\n\t"
+    "st %a[dst]+, r3"     "\n\t"
+    "st %a[dst]+, r4"     "\n\t"
+    "st %a[dst]+, r5"     "\n\t"
+    "st %a[dst]+, r6"     "\n\t"
+    "st %a[dst]+, r7"     "\n\t"
+    "st %a[dst]+, r8"     "\n\t"
+    "st %a[dst]+, r9"     "\n\t"
+    "st %a[dst]+, r10"    "\n\t"
+    "st %a[dst]+, r11"    "\n\t"
+    "st %a[dst]+, r12"    "\n\t"
+    "st %a[dst]+, r13"    "\n\t"
+    : [src] "+x" (src), [dst] "+z" (dst)
+    :
+    : "r2", "r3", "r4", "r5", "r6", "r7", "r8", "r9", "r10", "r11", "r12", "r13", "r16", "r17"
+    );
+}
+
+
+// Scale one row in the packed format for the global brightness.
+static void ledDriverScaleRow(const uint8_t *src, uint8_t *dst, const uint8_t factor)
+{
+    for (uint8_t i = 0; i < ledMatrixRowSize; ++i) {
+        dst[i] = nibbleScale(src[i], factor);
+    }
+}
+
+
+// This slices the "ledMatrix" into the bit planes of the "displayedLedMatrix".
+// With the color correction, each row is corrected before it is sliced.
+static void ledDriverBCMSlicePlanes()
+{
+    const uint8_t *src = ledMatrix();
+    uint8_t *dst = displayedLedMatrix;
+    uint8_t pixels[ledMatrixRowSize];
+    const uint8_t factor = brightnessScaleFactor();
+    for (uint8_t row = 0; row < numberOfRows; ++row) {
+        const uint8_t *rowPixels = src;
+        if (colorCorrectionEnabled) {
+            ledDriverCorrectRow(rowPixels, pixels);
+            rowPixels = pixels;
+        }
+        if (displayBrightness != maximumBrightness) {
+            ledDriverScaleRow(rowPixels, pixels, factor);
+            rowPixels = pixels;
+        }
+        ledDriverBCMSliceRow(rowPixels, dst);
+        src += ledMatrixRowSize;
+        dst += ledMatrixRowSize;
+    }
+}
+    
+
+// Draw the mono layer over the bit planes of the "displayedLedMatrix".
+static void ledDriverBCMMonoPlanes()
+{
+    const uint8_t factor = brightnessScaleFactor();
+    const uint8_t red = (monoRed * factor) >> 4;
+    const uint8_t green = (monoGreen * factor) >> 4;
+    const uint8_t blue = (monoBlue * factor) >> 4;
+    uint8_t *plane = displayedLedMatrix;
+    for (uint8_t row = 0; row < numberOfRows; ++row) {
+        const uint8_t mask = monoLayerShown[row];
+        if (mask == 0) {
+            plane += ledMatrixRowSize;
+            continue;
+        }
+        for (uint8_t bit = 1; bit < _BV(bitPlanes); bit <<= 1) {
+            plane[0] = (plane[0] & ~mask) | (((red & bit) != 0) ? mask : 0);
+            plane[1] = (plane[1] & ~mask) | (((green & bit) != 0) ? mask : 0);
+            plane[2] = (plane[2] & ~mask) | (((blue & bit) != 0) ? mask : 0);
+            plane += 3;
+        }
+    }
+}
+    
+
+// The BCM LED driver, called 4 times for each row and frame.
+//
+// Each row is shown for 4 time slots with the weights 1, 2, 4 and 8. In each
+// slot, a LED is enabled if the bit of the slot is set in its brightness value.
+// The bits are sliced into planes once for each application frame, so each
+// slot just has to shift out the bytes of its plane.
+static void ledDriverBCM()
+{
+    // Show the plane as fast as possible.
+    ledDriverBCMShowSlot();
+    
+    // After the longest slot of the last row, the "ledMatrix" is sliced
+    // into the "displayMatrix", depending on the application frame rate.
+    // The plane for this slot is already latched, so it can be overwritten.
+    if (drivenRow == (numberOfRows-1) && drivenBitPlane == (bitPlanes-1)) {
+        if (++drivenFrame >= applicationFrameRate) {
+            const bool present = ledDriverCheckPresent();
+            if (present) {
+                ledDriverMonoTake();
+            }
+            if (!present) {
+                // Nothing new to present, keep the displayed planes.
+            } else if ((activeDisplayOptions & MeggyJr::DisplayPalette) != 0) {
+                // Resolve each row of the palette image and slice it.
+                uint16_t colors[16];
+                ledDriverPaletteColors(colors);
+                uint8_t pixels[ledMatrixRowSize];
+                const uint8_t factor = brightnessScaleFactor();
+                for (uint8_t row = 0; row < numberOfRows; ++row) {
+                    ledDriverPaletteResolveRow(row, colors, false, pixels);
+                    if (displayBrightness != maximumBrightness) {
+                        ledDriverScaleRow(pixels, pixels, factor);
+                    }
+                    ledDriverBCMSliceRow(pixels, &displayedLedMatrix[row*ledMatrixRowSize]);
+                }
+                ledDriverBCMMonoPlanes();
+            } else {
+                ledDriverBCMSlicePlanes();
+                ledDriverBCMMonoPlanes();
+            }
+            ledDriverSignalFrame();
+        }
+    }
+    
+    // Call the sound driver at ~1.96kHz, two times for each row.
+    // But never at the same time as the display copy.
+    if ((drivenBitPlane & 1) == 0) {
+        soundDriver();
+    }
+
+    // Go to the next slot.
+    if (++drivenBitPlane == bitPlanes) {
+        drivenBitPlane = 0;
+        ++drivenRow;
+        drivenRow &= numberOfRowMask; // limit to 8 rows.
+    }
+}
+    
+    
+// The LED driver.
+static void ledDriver()
+{
+    // Turn the display off, because column bits get shifted.
+    displayOff();
+
+    if ((activeDisplayOptions & MeggyJr::DisplayBCM) != 0) {
+        ledDriverBCM();
+    } else {
+        ledDriverPWM();
+    }
+}
     
 
 }
@@ -1024,7 +2432,7 @@ static void ledDriver()
 MeggyJr meg;
 
 
-void MeggyJr::setup(FrameRate frameRate)
+void MeggyJr::setup(FrameRate frameRate, uint8_t displayOptions)
 {
     // 1. Setup the ports.
     //    Port C, all inputs with pull-ups.
@@ -1040,10 +2448,55 @@ void MeggyJr::setup(FrameRate frameRate)
     // 2. Turn the display off
     displayOff();
     
-    // 3. Set an initial state for the display.
+    // 3. Select the display options and allocate the matrix for drawing.
+    activeDisplayOptions = displayOptions;
+    if ((displayOptions & (DisplayBCM|DisplayPalette)) != 0) {
+        // The BCM driver needs the bit planes and the palette mode
+        // resolves the colors, there is nothing to flip. The high
+        // color mode is only supported by the PWM driver.
+        activeDisplayOptions &= ~(DisplayPageFlip|DisplayHighColor);
+    }
+    //    In palette mode, the index image and the palette are drawn
+    //    and only the displayed matrix needs the full size.
+    uint8_t *drawBuffer = static_cast<uint8_t*>(malloc(((activeDisplayOptions & DisplayPalette) != 0) ? paletteBufferSize : ledMatrixSize));
+    if (drawBuffer != 0) {
+        ledMatrixBuffers[0] = drawBuffer;
+    } else {
+        // Without memory, draw directly into the displayed matrix.
+        activeDisplayOptions &= DisplayExplicitPresent;
+    }
+    if ((activeDisplayOptions & DisplayHighColor) != 0) {
+        // The dithered matrix is displayed, there is nothing to flip.
+        activeDisplayOptions &= ~DisplayPageFlip;
+        highColorBuffer = static_cast<uint8_t*>(malloc(ledMatrixSize + highColorFractionSize*2));
+        if (highColorBuffer == 0) {
+            activeDisplayOptions &= ~DisplayHighColor;
+        } else {
+            memset(highColorFraction(), 0, highColorFractionSize);
+        }
+    }
+    if ((activeDisplayOptions & DisplayPalette) != 0) {
+        // Start with the predefined colors in the palette.
+        setPaletteColor(0, Color::black());
+        setPaletteColor(1, Color::red());
+        setPaletteColor(2, Color::orange());
+        setPaletteColor(3, Color::yellow());
+        setPaletteColor(4, Color::green());
+        setPaletteColor(5, Color::blue());
+        setPaletteColor(6, Color::violet());
+        setPaletteColor(7, Color::white());
+        setPaletteColor(8, Color::darkRed());
+        setPaletteColor(9, Color::darkOrange());
+        setPaletteColor(10, Color::darkYellow());
+        setPaletteColor(11, Color::darkGreen());
+        setPaletteColor(12, Color::darkBlue());
+        setPaletteColor(13, Color::darkViolet());
+        setPaletteColor(14, Color::gray());
+        setPaletteColor(15, Color::maximum());
+    }
+    
+    // 4. Set an initial state for the display and initialize the driver.
     clear();
-
-    // 4. Initialize the driver.
     ledDriverSetup();
     
     // 5. Initialize the SPI bus.
@@ -1052,19 +2505,52 @@ void MeggyJr::setup(FrameRate frameRate)
 
     // 6. Initialize the interrupt for the LEDs using timer 2.
     TCCR2A = _BV(WGM21); // OC0A/B and OC2A/B disconnected, CTC mode, TOP = OCRA
-    TCCR2B = _BV(CS21); // Use main clock 1/8 prescale.
-    //    Set the speed of the timer (set TOP).
-    OCR2A = F_CPU / 8 /*prescale*/ / 8 /*rows*/ / 16 /*levels*/ / 120 /*FPS*/;
+    if ((activeDisplayOptions & DisplayBCM) != 0) {
+        TCCR2B = _BV(CS22); // Use main clock 1/64 prescale.
+        //    The BCM driver sets TOP for each time slot.
+        OCR2A = pgm_read_byte(&drivenSlotTop[0]);
+    } else {
+        TCCR2B = _BV(CS21); // Use main clock 1/8 prescale.
+        //    Set the speed of the timer (set TOP).
+        OCR2A = F_CPU / 8 /*prescale*/ / 8 /*rows*/ / 16 /*levels*/ / 120 /*FPS*/;
+    }
+    displayTimerShift = ((activeDisplayOptions & DisplayBCM) != 0) ? 6 : 3;
+    displayCounts = 0;
+    displayInterruptCounts = 0;
+    displayLongestInterrupt = 0;
     TIMSK2 = _BV(OCIE2A); // Enable interrupt from timer 2 compare.
     
     // 7. Set the application frame to 0 and set all sync values to 0.
     applicationFrame = 0;
-    applicationFrameDuration = 0;
-    applicationFrameSyncLastTime = 0;
-    applicationFrameMeasureState = ApplicationFrameMeasure_Uninitialized;
+    applicationFrameSync = 0;
+    applicationFrameSyncSeen = 0;
+    applicationFramePrepared = false;
+    applicationIdleCallback = 0;
+    applicationLastFrame = 0;
+    applicationElapsedFrames = 1;
+    applicationMissedFrames = 0;
+    applicationWorstOverrun = 0;
+    loadFrameStarted = false;
+    resetLoadHistogram();
+    applicationIdleSleep = false;
+    applicationSleepCounts = 0;
+    applicationLastSleepCounts = 0;
+    applicationPresentRequest = false;
+    applicationFramePresented = false;
+    applicationFrameStartCounts = 0;
     
     // 8. Set the frame rate for the application.
     applicationFrameRate = frameRate;
+    //    Calculate the Timer2 counts of an application frame.
+    if ((activeDisplayOptions & DisplayBCM) != 0) {
+        uint16_t rowCounts = 0;
+        for (uint8_t i = 0; i < bitPlanes; ++i) {
+            rowCounts += pgm_read_byte(&drivenSlotTop[i]) + 1;
+        }
+        applicationFrameCounts = (uint32_t)rowCounts * numberOfRows * frameRate;
+    } else {
+        applicationFrameCounts = (uint32_t)(OCR2A + 1) * numberOfRows * brightnessLevels * frameRate;
+    }
     
     // 9. Initialize button states.
     buttonCurrentState = 0;
@@ -1078,71 +2564,184 @@ void MeggyJr::setup(FrameRate frameRate)
         soundState = SoundDisabled;
     }
  
-    // 12. Enable interrupts.
+    // 12. Paint the unused stack to measure the stack usage.
+    stackPaint();
+    
+    // 13. Enable interrupts.
     sei();
 }
 
+
+uint8_t MeggyJr::getDisplayOptions() const
+{
+    return activeDisplayOptions;
+}
+
+    
+// Measure the time spent in the display interrupt.
+// This is only called if the measurement is enabled, so the timebase
+// itself just adds the period to "displayCounts".
+static inline void displayMeasureInterrupt()
+{
+    // The timer restarted at 0 with the interrupt, so TCNT2 is the time spent here.
+    const uint8_t count = TCNT2;
+    displayInterruptCounts += count;
+    uint16_t longest = count;
+    if ((TIFR2 & _BV(OCF2A)) != 0) {
+        // The interrupt took longer than the period, the next one is pending.
+        longest = (uint8_t)(OCR2A + 1) + TCNT2;
+    }
+    if (longest > displayLongestInterrupt) {
+        displayLongestInterrupt = longest;
+    }
+}
+
     
 // The interrupt function to drive the LEDs.
 SIGNAL(TIMER2_COMPA_vect)
 {
+    // OCR2A is still the TOP of the period which just ended.
+    displayCounts += (uint8_t)(OCR2A + 1);
     ledDriver();
+    if (displayMeasureInterrupts) {
+        displayMeasureInterrupt();
+    }
 }
 
  
 void MeggyJr::clear()
 {
-    memset(ledMatrix, 0, ledMatrixSize);
-    extLedMatrix = 0;
+    clearPixels();
+    clearMono();
+    setExtraLeds(0);
 }
 
 
 void MeggyJr::setExtraLeds(uint8_t bits)
 {
+    extLedClearLevels();
     extLedMatrix = bits;
 }
 
     
 uint8_t MeggyJr::getExtraLeds() const
 {
-    return extLedMatrix;
+    return extLedMatrix | extLedDimmedMask;
 }
     
     
 void MeggyJr::enableExtraLed(uint8_t index)
 {
+    extLedClearLevel(index);
     extLedMatrix |= _BV(index);
 }
 
     
 void MeggyJr::disableExtraLed(uint8_t index)
 {
+    extLedClearLevel(index);
     extLedMatrix &= ~(_BV(index));
 }
 
     
 bool MeggyJr::isExtraLedEnabled(uint8_t index) const
 {
-    return (extLedMatrix & _BV(index)) != 0;
+    return ((extLedMatrix | extLedDimmedMask) & _BV(index)) != 0;
+}
+
+    
+void MeggyJr::setExtraLedBrightness(uint8_t index, uint8_t brightness)
+{
+    index &= 0x07;
+    if (brightness == 0) {
+        disableExtraLed(index);
+    } else if (brightness >= 15) {
+        enableExtraLed(index);
+    } else {
+        extLedMatrix &= ~_BV(index);
+        extLedLevels[index] = brightness;
+        extLedSetLevelBits(index, brightness);
+        extLedDimmedMask |= _BV(index);
+    }
+}
+
+    
+uint8_t MeggyJr::getExtraLedBrightness(uint8_t index) const
+{
+    index &= 0x07;
+    if ((extLedMatrix & _BV(index)) != 0) {
+        return 15;
+    } else if ((extLedDimmedMask & _BV(index)) != 0) {
+        return extLedLevels[index];
+    } else {
+        return 0;
+    }
+}
+
+    
+void MeggyJr::setExtraLedBar(uint8_t value, uint8_t maximum)
+{
+    if (maximum == 0) {
+        return;
+    }
+    if (value > maximum) {
+        value = maximum;
+    }
+    // The bar has 8 LEDs with 15 levels each.
+    uint8_t levels = (uint16_t)value * 120 / maximum;
+    for (uint8_t index = 0; index < 8; ++index) {
+        const uint8_t level = (levels > 15) ? 15 : levels;
+        if (getExtraLedBrightness(index) != level) {
+            setExtraLedBrightness(index, level);
+        }
+        levels -= level;
+    }
 }
     
 
 void MeggyJr::clearPixels()
 {
-    memset(ledMatrix, 0, ledMatrixSize);
+    if ((activeDisplayOptions & DisplayPalette) != 0) {
+        memset(paletteImage(), 0, paletteImageSize);
+    } else {
+        memset(ledMatrix(), 0, ledMatrixSize);
+        highColorClearAllFractions();
+    }
+}
+
+
+void MeggyJr::copyDisplayedPixels()
+{
+    // Without page flip, the displayed buffer does not contain packed pixels.
+    if ((activeDisplayOptions & DisplayPageFlip) == 0) {
+        return;
+    }
+    const uint8_t index = ledMatrixIndex;
+    memcpy(ledMatrixBuffers[index], ledMatrixBuffers[index^1], ledMatrixSize);
 }
     
     
 void MeggyJr::setPixel(int8_t x, int8_t y, const Color &color)
 {
-    const uint16_t c = color._color;
-    uint8_t* const target = &ledMatrix[(y>>1)*3+x*ledMatrixRowSize];
-    if ((y & 1) == 0) {
-        target[0] = c >> 4;
-        target[1] = (target[1] & 0x0F) | ((c << 4) & 0xFF);
-    } else {
-        target[1] = (target[1] & 0xF0) | (c >> 8);
-        target[2] = c & 0xFF;
+    // In palette mode, the "ledMatrix" contains no colors.
+    if (!ledMatrixHasColors()) {
+        return;
+    }
+    ledMatrixSetPixel(&ledMatrix()[x*ledMatrixRowSize], y, color._color);
+    if (highColorBuffer != 0) {
+        highColorSetFraction(x, y, 0, 0, 0);
+    }
+}
+
+
+void MeggyJr::setPixelHighColor(int8_t x, int8_t y, uint8_t red, uint8_t green, uint8_t blue)
+{
+    if (!ledMatrixHasColors()) {
+        return;
+    }
+    ledMatrixSetPixel(&ledMatrix()[x*ledMatrixRowSize], y, LRCOLOR_STATIC(red >> 2, green >> 2, blue >> 2));
+    if (highColorBuffer != 0) {
+        highColorSetFraction(x, y, red, green, blue);
     }
 }
 
@@ -1157,7 +2756,10 @@ void MeggyJr::setPixelS(int8_t x, int8_t y, const Color &color)
     
 Color MeggyJr::getPixel(int8_t x, int8_t y) const
 {
-    const uint8_t* const target = &ledMatrix[(y>>1)*3+x*ledMatrixRowSize];
+    if (!ledMatrixHasColors()) {
+        return Color::black();
+    }
+    const uint8_t* const target = &ledMatrix()[(y>>1)*3+x*ledMatrixRowSize];
     if ((y & 1) == 0) {
         return Color(target[0] >> 4, target[0] & 0x0F, target[1] >> 4);
     } else {
@@ -1175,70 +2777,476 @@ Color MeggyJr::getPixelS(int8_t x, int8_t y) const
     }
 }
 
+
+void MeggyJr::setPaletteColor(uint8_t index, const Color &color)
+{
+    // Without palette mode, the "ledMatrix" contains no palette.
+    if (ledMatrixHasColors()) {
+        return;
+    }
+    palette()[index & 0x0F] = color._color;
+}
+
     
-void MeggyJr::fillRect(int8_t x, int8_t y, uint8_t width, uint8_t height, const Color &color)
+Color MeggyJr::getPaletteColor(uint8_t index) const
 {
-    for (int8_t xd = 0; xd < width; ++xd) {
-        for (int8_t yd = 0; yd < height; ++yd) {
-            setPixel(x+xd, y+yd, color);
-        }
+    if (ledMatrixHasColors()) {
+        return Color::black();
     }
+    return Color(palette()[index & 0x0F]);
 }
 
     
-void MeggyJr::fillRectS(int8_t x, int8_t y, uint8_t width, uint8_t height, const Color &color)
+void MeggyJr::setPixelIndex(int8_t x, int8_t y, uint8_t index)
 {
-    for (int8_t xd = 0; xd < width; ++xd) {
-        for (int8_t yd = 0; yd < height; ++yd) {
-            setPixelS(x+xd, y+yd, color);
+    if (ledMatrixHasColors()) {
+        return;
+    }
+    uint8_t* const target = &paletteImage()[(y>>1)+x*paletteImageRowSize];
+    if ((y & 1) == 0) {
+        *target = (*target & 0x0F) | (index << 4);
+    } else {
+        *target = (*target & 0xF0) | (index & 0x0F);
+    }
+}
+
+    
+void MeggyJr::setPixelIndexS(int8_t x, int8_t y, uint8_t index)
+{
+    if (x>=0 && y>=0 && x<getScreenWidth() && y<getScreenHeight()) {
+        setPixelIndex(x, y, index & 0x0F);
+    }
+}
+
+    
+uint8_t MeggyJr::getPixelIndex(int8_t x, int8_t y) const
+{
+    if (ledMatrixHasColors()) {
+        return 0;
+    }
+    const uint8_t value = paletteImage()[(y>>1)+x*paletteImageRowSize];
+    if ((y & 1) == 0) {
+        return value >> 4;
+    } else {
+        return value & 0x0F;
+    }
+}
+
+    
+uint8_t MeggyJr::getPixelIndexS(int8_t x, int8_t y) const
+{
+    if (x>=0 && y>=0 && x<getScreenWidth() && y<getScreenHeight()) {
+        return getPixelIndex(x, y);
+    } else {
+        return 0;
+    }
+}
+
+    
+void MeggyJr::setMonoColor(const Color &color)
+{
+    monoRed = color.getRed();
+    monoGreen = color.getGreen();
+    monoBlue = color.getBlue();
+}
+
+    
+Color MeggyJr::getMonoColor() const
+{
+    return Color(monoRed, monoGreen, monoBlue);
+}
+
+    
+void MeggyJr::clearMono()
+{
+    memset(monoLayer, 0, numberOfRows);
+    monoLayerChanged = true;
+}
+
+    
+void MeggyJr::setMonoPixel(int8_t x, int8_t y, bool enabled)
+{
+    if (enabled) {
+        monoLayer[x] |= (0x80 >> y);
+    } else {
+        monoLayer[x] &= ~(0x80 >> y);
+    }
+    monoLayerChanged = true;
+}
+
+    
+void MeggyJr::setMonoPixelS(int8_t x, int8_t y, bool enabled)
+{
+    if (x>=0 && y>=0 && x<getScreenWidth() && y<getScreenHeight()) {
+        setMonoPixel(x, y, enabled);
+    }
+}
+
+    
+bool MeggyJr::isMonoPixelSet(int8_t x, int8_t y) const
+{
+    return (monoLayer[x] & (0x80 >> y)) != 0;
+}
+
+    
+void MeggyJr::setMonoRow(int8_t y, uint8_t bits)
+{
+    // The layer is stored by x position, so distribute the bits.
+    const uint8_t mask = (0x80 >> y);
+    for (uint8_t x = 0; x < numberOfRows; ++x) {
+        if ((bits & 0x80) != 0) {
+            monoLayer[x] |= mask;
+        } else {
+            monoLayer[x] &= ~mask;
         }
+        bits <<= 1;
     }
+    monoLayerChanged = true;
 }
 
+    
+uint8_t MeggyJr::getMonoRow(int8_t y) const
+{
+    const uint8_t mask = (0x80 >> y);
+    uint8_t bits = 0;
+    for (uint8_t x = 0; x < numberOfRows; ++x) {
+        bits <<= 1;
+        if ((monoLayer[x] & mask) != 0) {
+            bits |= 1;
+        }
+    }
+    return bits;
+}
 
-void MeggyJr::drawSprite(const uint8_t *spriteData, const uint8_t spriteDataCount, const int8_t x, const int8_t y, const Color &color)
+    
+void MeggyJr::drawMonoSprite(const uint8_t *spriteData, const uint8_t spriteDataCount, const int8_t x, const int8_t y)
 {
     // ignore sprite if it is off-screen.
     if (x < -7 || x >= getScreenWidth()) {
         return;
     }
-    uint8_t currentByte;
     for (int8_t dy = 0; dy < spriteDataCount; ++dy) {
         const int8_t ty = y+dy;
         if (ty >= 0 && ty < getScreenHeight()) {
-            currentByte = pgm_read_byte(spriteData + dy);
-            for (int8_t dx = 0; dx < 8; ++dx) {
-                if ((currentByte & 0x80) != 0) {
-                    setPixelS(x+dx, y+dy, color);
+            uint8_t bits = pgm_read_byte(spriteData + dy);
+            if (x >= 0) {
+                bits >>= x;
+            } else {
+                bits <<= -x;
+            }
+            // Set the bit of this row in each column of the sprite row.
+            const uint8_t mask = (0x80 >> ty);
+            for (uint8_t tx = 0; bits != 0; ++tx) {
+                if ((bits & 0x80) != 0) {
+                    monoLayer[tx] |= mask;
                 }
-                currentByte <<= 1;
+                bits <<= 1;
             }
         }
     }
+    monoLayerChanged = true;
+}
+
+    
+void MeggyJr::setCanvas(const Canvas *canvas, ViewportMode viewportMode)
+{
+    viewportCanvas = canvas;
+    viewportWrap = (viewportMode == ViewportWrap);
+    setViewport(viewportX, viewportY);
+}
+
+    
+void MeggyJr::setViewport(int16_t x, int16_t y)
+{
+    if (viewportCanvas != 0) {
+        viewportX = viewportLimit(x, viewportCanvas->getWidth());
+        viewportY = viewportLimit(y, viewportCanvas->getHeight());
+    } else {
+        viewportX = x;
+        viewportY = y;
+    }
+}
+
+    
+void MeggyJr::moveViewport(int8_t dx, int8_t dy)
+{
+    setViewport(viewportX + dx, viewportY + dy);
+}
+
+    
+int16_t MeggyJr::getViewportX() const
+{
+    return viewportX;
+}
+
+    
+int16_t MeggyJr::getViewportY() const
+{
+    return viewportY;
+}
+
+    
+void MeggyJr::setColorCorrection(const uint8_t *redTable, const uint8_t *greenTable, const uint8_t *blueTable)
+{
+    colorCorrectionEnabled = false;
+    memcpy(colorCorrection[0], redTable, 16);
+    memcpy(colorCorrection[1], greenTable, 16);
+    memcpy(colorCorrection[2], blueTable, 16);
+    colorCorrectionEnabled = true;
+}
+
+    
+void MeggyJr::setColorBalance(uint8_t redMaximum, uint8_t greenMaximum, uint8_t blueMaximum, bool gammaCorrection)
+{
+    colorCorrectionEnabled = false;
+    const uint8_t maximum[3] = {redMaximum, greenMaximum, blueMaximum};
+    for (uint8_t channel = 0; channel < 3; ++channel) {
+        for (uint8_t i = 0; i < 16; ++i) {
+            const uint8_t level = gammaCorrection ? pgm_read_byte(&colorGammaCurve[i]) : (i * 17);
+            colorCorrection[channel][i] = ((uint16_t)level * (maximum[channel] & 0x0F) + 127) / 255;
+        }
+    }
+    colorCorrectionEnabled = true;
+}
+
+    
+void MeggyJr::clearColorCorrection()
+{
+    colorCorrectionEnabled = false;
+}
+
+    
+void MeggyJr::setBrightness(uint8_t brightness)
+{
+    if (brightness > maximumBrightness) {
+        brightness = maximumBrightness;
+    }
+    brightnessFadeTarget = brightness;
+    displayBrightness = brightness;
+}
+
+    
+uint8_t MeggyJr::getBrightness() const
+{
+    return displayBrightness;
+}
+
+    
+void MeggyJr::fadeBrightness(uint8_t brightness, uint8_t framesPerStep)
+{
+    if (brightness > maximumBrightness) {
+        brightness = maximumBrightness;
+    }
+    brightnessFadeFrames = (framesPerStep > 0) ? framesPerStep : 1;
+    brightnessFadeCounter = 0;
+    brightnessFadeTarget = brightness;
+}
+
+    
+bool MeggyJr::isBrightnessFading() const
+{
+    return displayBrightness != brightnessFadeTarget;
+}
+
+    
+void MeggyJr::fillColumn(int8_t x, const Color &color)
+{
+    if (!ledMatrixHasColors()) {
+        return;
+    }
+    uint8_t pair[3];
+    ledMatrixPackPair(color._color, pair);
+    uint8_t *target = &ledMatrix()[x*ledMatrixRowSize];
+    for (uint8_t i = 0; i < 4; ++i) {
+        target[0] = pair[0];
+        target[1] = pair[1];
+        target[2] = pair[2];
+        target += 3;
+    }
+    highColorClearFraction(x, 0, 1, numberOfRows);
+}
+
+    
+void MeggyJr::fillVerticalSpan(int8_t x, int8_t y, uint8_t height, const Color &color)
+{
+    if (!ledMatrixHasColors()) {
+        return;
+    }
+    uint8_t pair[3];
+    ledMatrixPackPair(color._color, pair);
+    ledMatrixFillVerticalSpan(&ledMatrix()[x*ledMatrixRowSize], y, height, pair);
+    highColorClearFraction(x, y, 1, height);
+}
+
+    
+void MeggyJr::fillHorizontalSpan(int8_t x, int8_t y, uint8_t width, const Color &color)
+{
+    if (!ledMatrixHasColors()) {
+        return;
+    }
+    uint8_t pair[3];
+    ledMatrixPackPair(color._color, pair);
+    uint8_t *target = &ledMatrix()[(y>>1)*3+x*ledMatrixRowSize];
+    // All pixels of the span are in the same half of the pairs.
+    if ((y & 1) == 0) {
+        const uint8_t highNibble = pair[1] & 0xF0;
+        for (uint8_t i = 0; i < width; ++i) {
+            target[0] = pair[0];
+            target[1] = (target[1] & 0x0F) | highNibble;
+            target += ledMatrixRowSize;
+        }
+    } else {
+        const uint8_t lowNibble = pair[1] & 0x0F;
+        for (uint8_t i = 0; i < width; ++i) {
+            target[1] = (target[1] & 0xF0) | lowNibble;
+            target[2] = pair[2];
+            target += ledMatrixRowSize;
+        }
+    }
+    highColorClearFraction(x, y, width, 1);
+}
+
+    
+void MeggyJr::setColumnPixels(int8_t x, const Color *colors)
+{
+    if (!ledMatrixHasColors()) {
+        return;
+    }
+    uint8_t *target = &ledMatrix()[x*ledMatrixRowSize];
+    for (uint8_t i = 0; i < 4; ++i) {
+        const uint16_t upper = colors[0]._color;
+        const uint16_t lower = colors[1]._color;
+        target[0] = upper >> 4;
+        target[1] = (upper << 4) | (lower >> 8);
+        target[2] = lower;
+        target += 3;
+        colors += 2;
+    }
+    highColorClearFraction(x, 0, 1, numberOfRows);
+}
+
+    
+void MeggyJr::fillRect(int8_t x, int8_t y, uint8_t width, uint8_t height, const Color &color)
+{
+    if (!ledMatrixHasColors()) {
+        return;
+    }
+    uint8_t pair[3];
+    ledMatrixPackPair(color._color, pair);
+    uint8_t *column = &ledMatrix()[x*ledMatrixRowSize];
+    for (uint8_t i = 0; i < width; ++i) {
+        ledMatrixFillVerticalSpan(column, y, height, pair);
+        column += ledMatrixRowSize;
+    }
+    highColorClearFraction(x, y, width, height);
+}
+
+    
+void MeggyJr::fillRectS(int8_t x, int8_t y, uint8_t width, uint8_t height, const Color &color)
+{
+    // Clip the rectangle once, then fill it with the fast method.
+    int16_t left = x;
+    int16_t top = y;
+    int16_t right = left + width;
+    int16_t bottom = top + height;
+    if (left < 0) {
+        left = 0;
+    }
+    if (top < 0) {
+        top = 0;
+    }
+    if (right > getScreenWidth()) {
+        right = getScreenWidth();
+    }
+    if (bottom > getScreenHeight()) {
+        bottom = getScreenHeight();
+    }
+    if (left < right && top < bottom) {
+        fillRect(left, top, right-left, bottom-top, color);
+    }
+}
+
+
+void MeggyJr::drawSprite(const uint8_t *spriteData, const uint8_t spriteDataCount, const int8_t x, const int8_t y, const Color &color, const BlitMode blitMode)
+{
+    if (!ledMatrixHasColors()) {
+        return;
+    }
+    // Clip the sprite once.
+    if (x >= getScreenWidth() || y >= getScreenHeight() || x <= -8 || y + spriteDataCount <= 0) {
+        return;
+    }
+    const uint8_t startX = (x < 0) ? -x : 0;
+    const uint8_t endX = (x > 0) ? (getScreenWidth() - x) : 8;
+    const uint8_t startY = (y < 0) ? -y : 0;
+    const uint8_t endY = (y + spriteDataCount > getScreenHeight()) ? (getScreenHeight() - y) : spriteDataCount;
+    uint8_t* const firstColumn = &ledMatrix()[(x + startX)*ledMatrixRowSize];
+    uint8_t* const fraction = highColorDrawFraction();
+    for (uint8_t dy = startY; dy < endY; ++dy) {
+        uint8_t currentByte = pgm_read_byte(spriteData + dy) << startX;
+        uint8_t *column = firstColumn;
+        for (uint8_t dx = startX; dx < endX; ++dx) {
+            if ((currentByte & 0x80) != 0) {
+                if (blitMode == BlitReplace) {
+                    ledMatrixSetPixel(column, y + dy, color._color);
+                } else {
+                    ledMatrixBlitPixel(column, y + dy, color._color, blitMode);
+                }
+                if (fraction != 0) {
+                    fractionClearPixel(&fraction[(x + dx)*highColorFractionRowSize], y + dy);
+                }
+            }
+            currentByte <<= 1;
+            column += ledMatrixRowSize;
+        }
+    }
+}
+
+    
+void MeggyJr::drawSprite2bpp(const uint8_t *spriteData, const uint8_t width, const uint8_t height, const int8_t x, const int8_t y, const uint16_t *palette, const BlitMode blitMode)
+{
+    if (!ledMatrixHasColors()) {
+        return;
+    }
+    ledMatrixDrawIndexedSprite(spriteData, 2, width, height, x, y, palette, blitMode, highColorDrawFraction());
+}
+
+    
+void MeggyJr::drawSprite4bpp(const uint8_t *spriteData, const uint8_t width, const uint8_t height, const int8_t x, const int8_t y, const uint16_t *palette, const BlitMode blitMode)
+{
+    if (!ledMatrixHasColors()) {
+        return;
+    }
+    ledMatrixDrawIndexedSprite(spriteData, 4, width, height, x, y, palette, blitMode, highColorDrawFraction());
 }
 
     
 void MeggyJr::scrollPixel(ScrollDirection scrollDirection)
 {
+    if (!ledMatrixHasColors()) {
+        return;
+    }
+    highColorScrollFraction(scrollDirection);
     // While scrolling left and right is just moving bytes around,
     // scrolling up and down requires a bit shift which is way to
     // slow in C++. Nice to have a RISC with lots of registers.
+    uint8_t * const lm = ledMatrix();
     switch (scrollDirection) {
         case ScrollLeft:
         {
             uint8_t pixels[ledMatrixRowSize];
-            memcpy(pixels, ledMatrix, ledMatrixRowSize);
-            memmove(ledMatrix, ledMatrix+ledMatrixRowSize, ledMatrixRowSize*7);
-            memcpy(ledMatrix+(7*ledMatrixRowSize), pixels, ledMatrixRowSize);
+            memcpy(pixels, lm, ledMatrixRowSize);
+            memmove(lm, lm+ledMatrixRowSize, ledMatrixRowSize*7);
+            memcpy(lm+(7*ledMatrixRowSize), pixels, ledMatrixRowSize);
         }
         break;
         
         case ScrollRight:
         {
             uint8_t pixels[ledMatrixRowSize];
-            memcpy(pixels, ledMatrix+(7*ledMatrixRowSize), ledMatrixRowSize);
-            memmove(ledMatrix+ledMatrixRowSize, ledMatrix, ledMatrixRowSize*7);
-            memcpy(ledMatrix, pixels, ledMatrixRowSize);
+            memcpy(pixels, lm+(7*ledMatrixRowSize), ledMatrixRowSize);
+            memmove(lm+ledMatrixRowSize, lm, ledMatrixRowSize*7);
+            memcpy(lm, pixels, ledMatrixRowSize);
         }
         break;
             
@@ -1246,7 +3254,7 @@ void MeggyJr::scrollPixel(ScrollDirection scrollDirection)
         {
             // Asm necessary because of speed.
             // rol seems slow, but swap needs and and mov.
-            uint8_t *p = ledMatrix;
+            uint8_t *p = lm;
             asm volatile(
             "ldi r17, 8"          "\n"
             "L_sl2%=: "
@@ -1304,7 +3312,7 @@ void MeggyJr::scrollPixel(ScrollDirection scrollDirection)
 
         case ScrollDown:
         {
-            uint8_t *p = ledMatrix;
+            uint8_t *p = lm;
             asm volatile(
             "ldi r17, 8"          "\n"
             "L_sl2%=: "
@@ -1365,8 +3373,11 @@ void MeggyJr::scrollPixel(ScrollDirection scrollDirection)
     
 void MeggyJr::fadePixel()
 {
+    if (!ledMatrixHasColors()) {
+        return;
+    }
     // Fading the colors is way to slow in C++
-    uint8_t *p = ledMatrix;
+    uint8_t *p = ledMatrix();
     asm volatile(
     "ldi r18, 96"         "\n"
     "L_sl2%=: "
@@ -1390,22 +3401,373 @@ void MeggyJr::fadePixel()
     : [p] "z" (p)
     : "r16", "r17", "r18"
     );
+    highColorClearAllFractions();
 }
 
 
+void MeggyJr::fadePixel(uint8_t factor)
+{
+    if (!ledMatrixHasColors()) {
+        return;
+    }
+    uint8_t *p = ledMatrix();
+    for (uint8_t i = 0; i < ledMatrixSize; ++i) {
+        p[i] = nibbleScale(p[i], factor);
+    }
+    highColorClearAllFractions();
+}
+
+    
+void MeggyJr::fadePixelTo(const Color &color)
+{
+    if (!ledMatrixHasColors()) {
+        return;
+    }
+    uint8_t pair[3];
+    ledMatrixPackPair(color._color, pair);
+    const uint16_t target[3] = {nibbleSpread(pair[0]), nibbleSpread(pair[1]), nibbleSpread(pair[2])};
+    uint8_t *p = ledMatrix();
+    for (uint8_t i = 0; i < ledMatrixSize; i += 3) {
+        p[0] = nibbleStepToward(p[0], target[0]);
+        p[1] = nibbleStepToward(p[1], target[1]);
+        p[2] = nibbleStepToward(p[2], target[2]);
+        p += 3;
+    }
+    highColorClearAllFractions();
+}
+
+    
+void MeggyJr::fadePixelTo(const Canvas &canvas)
+{
+    if (!ledMatrixHasColors()) {
+        return;
+    }
+    if (canvas._width != getScreenWidth() || canvas._height != getScreenHeight()) {
+        return;
+    }
+    uint8_t *p = ledMatrix();
+    for (uint8_t i = 0; i < ledMatrixSize; ++i) {
+        p[i] = nibbleStepToward(p[i], nibbleSpread(canvas.readByte(i)));
+    }
+    highColorClearAllFractions();
+}
+
+    
+void MeggyJr::addPixels(const Canvas &canvas)
+{
+    if (!ledMatrixHasColors()) {
+        return;
+    }
+    if (canvas._width != getScreenWidth() || canvas._height != getScreenHeight()) {
+        return;
+    }
+    uint8_t *p = ledMatrix();
+    for (uint8_t i = 0; i < ledMatrixSize; ++i) {
+        p[i] = nibbleAddSaturate(p[i], canvas.readByte(i));
+    }
+    highColorClearAllFractions();
+}
+
+    
+void MeggyJr::averagePixels(const Canvas &canvas)
+{
+    if (!ledMatrixHasColors()) {
+        return;
+    }
+    if (canvas._width != getScreenWidth() || canvas._height != getScreenHeight()) {
+        return;
+    }
+    uint8_t *p = ledMatrix();
+    for (uint8_t i = 0; i < ledMatrixSize; ++i) {
+        p[i] = nibbleAverage(p[i], canvas.readByte(i));
+    }
+    highColorClearAllFractions();
+}
+
+
+void MeggyJr::present()
+{
+    presentPrepare();
+    applicationPresentRequest = true;
+}
+
+
+bool MeggyJr::isFramePresented() const
+{
+    return applicationFramePresented;
+}
+
+    
 uint32_t MeggyJr::frameSync()
 {
+    applicationRecordLoad();
+    if ((activeDisplayOptions & DisplayExplicitPresent) == 0) {
+        presentPrepare();
+    }
     const uint8_t lastValue = applicationFrameSync;
-    while (applicationFrameSync == lastValue) {};
-    return applicationFrame;
+    while (applicationFrameSync == lastValue) {
+        if (applicationIdleCallback != 0) {
+            applicationIdleCallback();
+        }
+        if (applicationIdleSleep) {
+            applicationSleep(lastValue);
+        }
+    }
+    applicationLastSleepCounts = applicationSleepCounts;
+    applicationSleepCounts = 0;
+    applicationConsumeFrame();
+    return applicationLastFrame;
+}
+
+    
+bool MeggyJr::isFrameReady() const
+{
+    return applicationFrameSync != applicationFrameSyncSeen;
+}
+
+    
+bool MeggyJr::pollFrame()
+{
+    if (!applicationFramePrepared) {
+        applicationRecordLoad();
+        if ((activeDisplayOptions & DisplayExplicitPresent) == 0) {
+            presentPrepare();
+        }
+        applicationFramePrepared = true;
+    }
+    if (applicationFrameSync == applicationFrameSyncSeen) {
+        return false;
+    }
+    applicationConsumeFrame();
+    return true;
+}
+
+    
+uint32_t MeggyJr::getFrame() const
+{
+    cli();
+    const uint32_t frame = applicationFrame;
+    sei();
+    return frame;
+}
+
+    
+void MeggyJr::setIdleCallback(IdleCallback callback)
+{
+    applicationIdleCallback = callback;
+}
+
+
+uint32_t MeggyJr::getFrameDuration() const
+{
+    return displayCountsToMicroseconds(applicationFrameCounts);
+}
+
+    
+uint32_t MeggyJr::getFrameTime() const
+{
+    if (applicationLastFrame == 0) {
+        return 0;
+    }
+    return displayCountsToMicroseconds(displayTimestamp() - applicationFrameStartCounts);
+}
+
+    
+uint32_t MeggyJr::getFrameCycles() const
+{
+    return applicationFrameCounts << displayTimerShift;
+}
+
+    
+uint8_t MeggyJr::getElapsedFrames() const
+{
+    return applicationElapsedFrames;
+}
+
+    
+uint32_t MeggyJr::getMissedFrames() const
+{
+    return applicationMissedFrames;
+}
+
+    
+uint8_t MeggyJr::getWorstOverrun() const
+{
+    return applicationWorstOverrun;
+}
+
+    
+void MeggyJr::resetMissedFrames()
+{
+    applicationMissedFrames = 0;
+    applicationWorstOverrun = 0;
+}
+
+    
+void MeggyJr::resetLoadHistogram()
+{
+    for (uint8_t i = 0; i < loadHistogramSize; ++i) {
+        loadHistogram[i] = 0;
+    }
+    loadWorstFrameCounts = 0;
+    loadWorstFrame = 0;
+}
+
+    
+uint16_t MeggyJr::getLoadHistogram(uint8_t bucket) const
+{
+    if (bucket >= loadHistogramSize) {
+        return 0;
+    }
+    return loadHistogram[bucket];
+}
+
+    
+uint32_t MeggyJr::getWorstFrameTime() const
+{
+    return displayCountsToMicroseconds(loadWorstFrameCounts);
+}
+
+    
+uint32_t MeggyJr::getWorstFrame() const
+{
+    return loadWorstFrame;
+}
+
+    
+void MeggyJr::printLoadHistogram(Print &output) const
+{
+    output.print("load ");
+    output.print(getFrameDuration());
+    output.print(" ");
+    output.print(getWorstFrameTime());
+    output.print(" ");
+    output.print(loadWorstFrame);
+    for (uint8_t i = 0; i < loadHistogramSize; ++i) {
+        output.print(" ");
+        output.print(loadHistogram[i]);
+    }
+    output.println();
+}
+
+    
+void MeggyJr::writeLoadHistogram(Print &output) const
+{
+    uint8_t record[LoadHistogramRecordSize];
+    uint8_t *p = record;
+    *p++ = 'L';
+    *p++ = loadHistogramSize;
+    const uint32_t values[3] = {getFrameDuration(), getWorstFrameTime(), loadWorstFrame};
+    for (uint8_t i = 0; i < 3; ++i) {
+        *p++ = values[i];
+        *p++ = values[i] >> 8;
+        *p++ = values[i] >> 16;
+        *p++ = values[i] >> 24;
+    }
+    for (uint8_t i = 0; i < loadHistogramSize; ++i) {
+        *p++ = loadHistogram[i];
+        *p++ = loadHistogram[i] >> 8;
+    }
+    uint8_t checksum = 0;
+    for (uint8_t *q = record; q != p; ++q) {
+        checksum += *q;
+    }
+    *p = checksum;
+    output.write(record, LoadHistogramRecordSize);
+}
+
+    
+uint32_t MeggyJr::getCycleCount() const
+{
+    return displayTimestamp() << displayTimerShift;
+}
+
+    
+uint32_t MeggyJr::getInterruptCycleCount() const
+{
+    cli();
+    const uint32_t counts = displayInterruptCounts;
+    sei();
+    return counts << displayTimerShift;
+}
+
+    
+void MeggyJr::setInterruptMeasurement(bool enabled)
+{
+    displayMeasureInterrupts = enabled;
+}
+
+    
+bool MeggyJr::isInterruptMeasurementEnabled() const
+{
+    return displayMeasureInterrupts;
+}
+
+    
+void MeggyJr::getCycleCounts(uint32_t &cycles, uint32_t &interruptCycles) const
+{
+    cli();
+    const uint32_t counts = displayTimestamp();
+    const uint32_t interruptCounts = displayInterruptCounts;
+    sei();
+    cycles = counts << displayTimerShift;
+    interruptCycles = interruptCounts << displayTimerShift;
+}
+
+    
+uint32_t MeggyJr::getCodeCycleCount() const
+{
+    uint32_t cycles;
+    uint32_t interruptCycles;
+    getCycleCounts(cycles, interruptCycles);
+    return cycles - interruptCycles;
+}
+
+    
+uint16_t MeggyJr::getLongestInterruptCycles() const
+{
+    cli();
+    const uint16_t counts = displayLongestInterrupt;
+    sei();
+    return counts << displayTimerShift;
+}
+
+    
+void MeggyJr::resetLongestInterrupt()
+{
+    cli();
+    displayLongestInterrupt = 0;
+    sei();
+}
+
+    
+void MeggyJr::setIdleSleep(bool enabled)
+{
+    applicationIdleSleep = enabled;
+}
+
+    
+bool MeggyJr::isIdleSleepEnabled() const
+{
+    return applicationIdleSleep;
+}
+
+    
+uint8_t MeggyJr::getSleepPercentage() const
+{
+    const uint32_t percentage = applicationLastSleepCounts * 100 / applicationFrameCounts;
+    if (percentage > 100) {
+        return 100;
+    }
+    return percentage;
 }
     
     
 uint32_t MeggyJr::frameSyncShowLoad()
 {
-    if (applicationFrameMeasureState == ApplicationFrameMeasure_Ready) {
-        const uint32_t frameTimeDelta = micros() - applicationFrameSyncLastTime;
-        const uint16_t load = frameTimeDelta * 8 / applicationFrameDuration;
+    if (applicationLastFrame != 0) {
+        const uint32_t frameCounts = displayTimestamp() - applicationFrameStartCounts;
+        const uint16_t load = frameCounts * 8 / applicationFrameCounts;
         if (load < 8) {
             setExtraLeds(((uint16_t)1 << load)-1);
         } else {
@@ -1418,9 +3780,15 @@ uint32_t MeggyJr::frameSyncShowLoad()
     } else {
         setExtraLeds(B00011000); // Wait for first real value.
     }
-    const uint32_t frame = frameSync();
-    applicationFrameSyncLastTime = micros();
-    return frame;
+    return frameSync();
+}
+    
+    
+uint32_t MeggyJr::frameSyncShowSleep()
+{
+    const uint8_t sleepLeds = (getSleepPercentage() * 8 + 50) / 100;
+    setExtraLeds(((uint16_t)1 << sleepLeds)-1);
+    return frameSync();
 }
     
     
@@ -1428,18 +3796,39 @@ uint32_t MeggyJr::frameSyncShowFreeRAM()
 {
     int free_memory;
     free_memory = (int)&free_memory - (__brkval==0?(int)&__heap_start:(int)__brkval);
-    if (free_memory < 0) {
-        setExtraLeds(B11110000);
-    } else if (free_memory < 256) {
-        const uint16_t load = free_memory/32;
-        setExtraLeds(((uint16_t)1 << load)-1);
-    } else {
-        setExtraLeds(B11111111);
-    }
+    setExtraLeds(freeMemoryLeds(free_memory));
     return frameSync();
 }
 
     
+uint32_t MeggyJr::frameSyncShowStack()
+{
+    setExtraLeds(freeMemoryLeds(getStackFree()));
+    return frameSync();
+}
+
+    
+uint16_t MeggyJr::getStackUsage() const
+{
+    return (uint16_t)(RAMEND + 1) - (uint16_t)stackLowestUsed;
+}
+
+    
+int16_t MeggyJr::getStackFree() const
+{
+    return (int16_t)((uint16_t)stackLowestUsed - (uint16_t)stackPaintStart);
+}
+
+    
+void MeggyJr::printStackUsage(Print &output) const
+{
+    output.print("stack ");
+    output.print(getStackUsage());
+    output.print(" ");
+    output.println(getStackFree());
+}
+
+    
 bool MeggyJr::isAButtonPressed() const
 {
     const uint8_t last = buttonLastState & ButtonA;
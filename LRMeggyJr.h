@@ -24,8 +24,14 @@
 
 
 // Include the own definitions.
+#include "LRCanvas.h"
 #include "LRColor.h"
+#include "LRProfiler.h"
+#include "LRScheduler.h"
 #include "LRSoundToken.h"
+#include "LRSprite.h"
+#include "LRTileMap.h"
+#include "LRTransition.h"
 
 
 namespace lr {
@@ -71,9 +77,95 @@ public:
         ScrollRight = 0x3
     };
     
+    /// How sprites are combined with the pixels on the screen.
+    enum BlitMode : uint8_t {
+        BlitReplace   = 0x0, // The sprite pixels replace the screen pixels.
+        BlitOr        = 0x1, // The color channels are combined with a bitwise OR.
+        BlitXor       = 0x2, // The color channels are combined with a bitwise XOR. Drawing twice restores the screen.
+        BlitAndNot    = 0x3, // The bits of the sprite color are cleared from the screen pixels.
+        BlitOntoBlack = 0x4  // The sprite pixels are only drawn onto black screen pixels.
+    };
+    
+    /// How the viewport handles the edges of the canvas.
+    enum ViewportMode : uint8_t {
+        ViewportClamp = 0x0, // The viewport stops at the edges of the canvas.
+        ViewportWrap  = 0x1  // The viewport wraps around at the edges of the canvas.
+    };
+
+    /// Options for the display driver.
+    ///
+    /// Combine the options using the binary or operator and
+    /// pass them to the setup() method.
+    ///
+    enum DisplayOption : uint8_t {
+        DisplayDefault         = 0x00, // PWM driver, each row is shown in 16 equal time slots.
+        DisplayBCM             = 0x01, // BCM driver, each row is shown in 4 weighted time slots (1, 2, 4, 8).
+        DisplayPageFlip        = 0x02, // Flip the display buffers instead of copying them (PWM driver only).
+        DisplayExplicitPresent = 0x04, // Only show frames which are marked as complete using present().
+        DisplayPalette         = 0x08, // Draw 4 bit indexes into a palette of 16 colors.
+        DisplayHighColor       = 0x10, // 6 bits for each channel using temporal dithering (PWM driver only).
+    };
+
 public:
     /// The setup method to initialize the interface.
-    void setup(FrameRate frameRate = FrameRate30);
+    ///
+    /// The default PWM driver calls the display interrupt 16 times for
+    /// each row and frame. The BCM (binary code modulation) driver shows each
+    /// row in 4 time slots with the weights 1, 2, 4 and 8, one for each bit
+    /// of the brightness. It calls the interrupt only 4 times for each row
+    /// and frame, which leaves a lot more time for your code. The display
+    /// refresh rate of the BCM driver is ~122Hz instead of 120Hz.
+    ///
+    /// Estimated from the instruction counts, and not measured yet, a PWM
+    /// interrupt takes ~250 cycles (~24% of the CPU), the BCM driver uses
+    /// ~7% of the CPU. Run the DriverBenchmark example to measure the load
+    /// and the cycles for each interrupt on your device.
+    ///
+    /// The BCM driver slices the matrix into bit planes once for each
+    /// application frame, so each time slot just shifts out three bytes.
+    /// By the same unmeasured estimate, this takes a slot from ~300 to
+    /// ~170 cycles, and the slicing adds ~2200 cycles to one slot of each
+    /// application frame.
+    ///
+    /// By default, the driver copies the drawn pixels into the displayed
+    /// buffer for each application frame. With the DisplayPageFlip option,
+    /// the driver just flips both buffers, and you continue drawing into the
+    /// previously displayed buffer. Use copyDisplayedPixels() after frameSync()
+    /// if you draw incrementally. This option is ignored for the BCM driver.
+    ///
+    /// With the DisplayExplicitPresent option, the driver only copies
+    /// (or flips) the pixels after you called present(). Half drawn
+    /// frames are never shown and unchanged frames cost nothing. This
+    /// includes the mono layer, call present() after changing it as well.
+    ///
+    /// With the DisplayPalette option, each pixel is a 4 bit index into a
+    /// palette of 16 colors. The drawn buffer needs only 64 bytes for the
+    /// index image and the palette, instead of 96 bytes for the colors.
+    /// The PWM driver resolves one row of each presented frame after its
+    /// last brightness level, so a changed palette is visible with the next
+    /// presented frame without redrawing. The rows are read during the last
+    /// brightness level of the frame, so finish drawing (or call present())
+    /// before it. The palette starts with the 16 predefined colors. In this
+    /// mode, use the index methods to draw, the color methods do nothing
+    /// and getPixel() returns black.
+    ///
+    /// The matrix you draw into is allocated in this method. If there is
+    /// not enough memory, all options except DisplayExplicitPresent are
+    /// ignored and you draw directly into the displayed matrix.
+    ///
+    /// @param frameRate The frame rate for the application.
+    /// @param displayOptions A combination of DisplayOption values.
+    ///
+    void setup(FrameRate frameRate = FrameRate30, uint8_t displayOptions = DisplayDefault);
+    
+    /// Get the display options which are active after setup().
+    ///
+    /// Options which are not supported together, or which need more
+    /// memory than available, are not included.
+    ///
+    /// @return A combination of DisplayOption values.
+    ///
+    uint8_t getDisplayOptions() const;
     
     /// Clear the display and extra LEDs. All LEDs go black.
     void clear();
@@ -88,6 +180,18 @@ public:
     ///
     void clearPixels();
     
+    /// Copy the displayed pixels into the pixels you draw.
+    ///
+    /// This is only useful with the DisplayPageFlip option. After a
+    /// flip, you draw into the buffer which was displayed before. Call
+    /// this method right after frameSync() to continue drawing on the
+    /// pixels of the last frame.
+    ///
+    /// Without the DisplayPageFlip option, or if the option is ignored
+    /// by the driver, this method does nothing.
+    ///
+    void copyDisplayedPixels();
+    
     /// Set the color of a pixel.
     ///
     /// @param x The x position of the pixel (0-7).
@@ -104,6 +208,34 @@ public:
     ///
     void setPixelS(int8_t x, int8_t y, const Color &color);
     
+    /// Set the color of a pixel with 6 bits for each channel.
+    ///
+    /// This is only used with the DisplayHighColor option. The driver
+    /// switches between the two nearest of the 16 brightness levels in
+    /// each frame, to show 61 levels for each channel. Without the option,
+    /// the upper 4 bits of each channel are used.
+    ///
+    /// The high color mode allocates 192 bytes in setup(). Each row is
+    /// dithered once for each frame after its last brightness level,
+    /// which adds a few hundred cycles to 8 of the 128 interrupts of a
+    /// frame. When a frame is presented, each row is also taken at this
+    /// point, so no interrupt handles more than one row. The rows are
+    /// read during the last brightness level of the frame, so finish
+    /// drawing (or call present()) before it. Use setInterruptMeasurement()
+    /// and getLongestInterruptCycles() to check the interrupt on your device.
+    ///
+    /// All other drawing methods and the canvas viewport reset the extra
+    /// bits of the pixels they change. scrollPixel() moves them with the
+    /// pixels.
+    ///
+    /// @param x The x position of the pixel (0-7).
+    /// @param y The y position of the pixel (0-7).
+    /// @param red The red part of the color (0-63).
+    /// @param green The green part of the color (0-63).
+    /// @param blue The blue part of the color (0-63).
+    ///
+    void setPixelHighColor(int8_t x, int8_t y, uint8_t red, uint8_t green, uint8_t blue);
+    
     /// Get the color from a pixel.
     ///
     /// @param x The x position of the pixel (0-7).
@@ -120,8 +252,172 @@ public:
     ///
     Color getPixelS(int8_t x, int8_t y) const;
     
+    /// Set a color in the palette.
+    ///
+    /// This is only used with the DisplayPalette option, otherwise it does nothing.
+    ///
+    /// @param index The index of the color in the palette (0-15).
+    /// @param color The new color.
+    ///
+    void setPaletteColor(uint8_t index, const Color &color);
+    
+    /// Get a color from the palette.
+    ///
+    /// This is only used with the DisplayPalette option, otherwise it returns black.
+    ///
+    /// @param index The index of the color in the palette (0-15).
+    /// @return The color in the palette.
+    ///
+    Color getPaletteColor(uint8_t index) const;
+    
+    /// Set the palette index of a pixel.
+    ///
+    /// This is only used with the DisplayPalette option, otherwise it does nothing.
+    ///
+    /// @param x The x position of the pixel (0-7).
+    /// @param y The y position of the pixel (0-7).
+    /// @param index The index of the color in the palette (0-15).
+    ///
+    void setPixelIndex(int8_t x, int8_t y, uint8_t index);
+    
+    /// Set the palette index of a pixel ignore off screen pixels.
+    ///
+    /// This is only used with the DisplayPalette option, otherwise it does nothing.
+    ///
+    /// @param x The x position of the pixel (0-7).
+    /// @param y The y position of the pixel (0-7).
+    /// @param index The index of the color in the palette (0-15).
+    ///
+    void setPixelIndexS(int8_t x, int8_t y, uint8_t index);
+    
+    /// Get the palette index of a pixel.
+    ///
+    /// This is only used with the DisplayPalette option, otherwise it returns 0.
+    ///
+    /// @param x The x position of the pixel (0-7).
+    /// @param y The y position of the pixel (0-7).
+    /// @return The index of the color in the palette.
+    ///
+    uint8_t getPixelIndex(int8_t x, int8_t y) const;
+    
+    /// Get the palette index of a pixel ignore off screen pixels.
+    ///
+    /// This is only used with the DisplayPalette option, otherwise it returns 0.
+    ///
+    /// @param x The x position of the pixel (0-7).
+    /// @param y The y position of the pixel (0-7).
+    /// @return The index of the color in the palette or 0 if the pixel is not on the screen.
+    ///
+    uint8_t getPixelIndexS(int8_t x, int8_t y) const;
+    
+    /// Set the color correction for the display.
+    ///
+    /// Each channel of a pixel is mapped through a table with 16 entries,
+    /// so the application can use linear colors and the different LED
+    /// brightness is corrected. The correction is applied once for each
+    /// presented frame, never for each brightness level. The PWM driver
+    /// corrects one row after its last brightness level, the BCM driver
+    /// corrects the rows while the frame is sliced. The pixels you draw
+    /// are not changed.
+    ///
+    /// In palette mode, the colors are corrected while the rows are resolved.
+    /// In page flip mode, the drawn pixels are displayed directly, so the
+    /// correction is not applied. The mono layer is never corrected.
+    ///
+    /// @param redTable A table with 16 values (0-15) for the red channel.
+    /// @param greenTable A table with 16 values (0-15) for the green channel.
+    /// @param blueTable A table with 16 values (0-15) for the blue channel.
+    ///
+    void setColorCorrection(const uint8_t *redTable, const uint8_t *greenTable, const uint8_t *blueTable);
+    
+    /// Set the color correction from the maximum of each channel.
+    ///
+    /// The tables map the full channel value 15 to the given maximum. This
+    /// balances white, e.g. setColorBalance(14, 4, 2) displays the white
+    /// color 15,15,15 like the predefined white.
+    ///
+    /// @param redMaximum The maximum value for the red channel (0-15).
+    /// @param greenMaximum The maximum value for the green channel (0-15).
+    /// @param blueMaximum The maximum value for the blue channel (0-15).
+    /// @param gammaCorrection true to apply a gamma curve of 2.2, false for a linear mapping.
+    ///
+    void setColorBalance(uint8_t redMaximum, uint8_t greenMaximum, uint8_t blueMaximum, bool gammaCorrection = true);
+    
+    /// Remove the color correction.
+    ///
+    void clearColorCorrection();
+    
+    /// Set the global brightness of the display.
+    ///
+    /// The brightness is applied by the display driver and does not
+    /// change the pixels, so it can be changed every frame without
+    /// any drawing. The PWM driver maps the brightness levels through
+    /// a table and applies it with the next row. The BCM driver scales
+    /// the colors while slicing, so the brightness is applied with the
+    /// next presented frame.
+    ///
+    /// @param brightness The brightness from 0 (off) to 15 (full).
+    ///
+    void setBrightness(uint8_t brightness);
+    
+    /// Get the global brightness of the display.
+    ///
+    /// @return The current brightness (0-15).
+    ///
+    uint8_t getBrightness() const;
+    
+    /// Fade the global brightness in the background.
+    ///
+    /// The brightness is changed by one step after the given number of
+    /// frames, until the brightness is reached. Use it to fade the whole
+    /// screen in or out, without changing the pixels.
+    ///
+    /// @param brightness The brightness to fade to (0-15).
+    /// @param framesPerStep The number of frames for each step.
+    ///
+    void fadeBrightness(uint8_t brightness, uint8_t framesPerStep = 1);
+    
+    /// Check if the global brightness is fading.
+    ///
+    bool isBrightnessFading() const;
+    
+    /// Fill a column with a given color.
+    ///
+    /// @param x The x position of the column (0-7).
+    /// @param color The color for the column.
+    ///
+    void fillColumn(int8_t x, const Color &color);
+    
+    /// Fill a vertical span of pixels with a given color.
+    ///
+    /// @param x The x position of the span (0-7).
+    /// @param y The y position of the first pixel (0-7).
+    /// @param height The number of pixels to fill. The span has to fit on the screen.
+    /// @param color The color for the pixels.
+    ///
+    void fillVerticalSpan(int8_t x, int8_t y, uint8_t height, const Color &color);
+    
+    /// Fill a horizontal span of pixels with a given color.
+    ///
+    /// @param x The x position of the first pixel (0-7).
+    /// @param y The y position of the span (0-7).
+    /// @param width The number of pixels to fill. The span has to fit on the screen.
+    /// @param color The color for the pixels.
+    ///
+    void fillHorizontalSpan(int8_t x, int8_t y, uint8_t width, const Color &color);
+    
+    /// Set the colors of all pixels in a column.
+    ///
+    /// @param x The x position of the column (0-7).
+    /// @param colors An array with 8 colors, from the top to the bottom pixel.
+    ///
+    void setColumnPixels(int8_t x, const Color *colors);
+    
     /// Fill a rectangle with a given color
     ///
+    /// The rectangle is filled column by column with vertical spans,
+    /// so most pixels are written as pairs.
+    ///
     void fillRect(int8_t x, int8_t y, uint8_t width, uint8_t height, const Color &color);
 
     /// Fill a rectangle with a given color ignore off screen pixels.
@@ -140,8 +436,45 @@ public:
     /// @param x The X position of the top left corner of the sprite.
     /// @param y The Y position of the top left corner of the sprite.
     /// @param color The color to use for the enabled pixels.
+    /// @param blitMode How the enabled pixels are combined with the screen.
+    ///
+    void drawSprite(const uint8_t *spriteData, const uint8_t spriteDataCount, const int8_t x, const int8_t y, const Color &color, const BlitMode blitMode = BlitReplace);
+    
+    /// Draw a sprite with 4 colors on the screen.
+    ///
+    /// The sprite has to be defined in program memory, using the LRSPRITE_2BPP_ROW()
+    /// macro for each row. Each pixel is an index into the palette, where index 0
+    /// is transparent. The palette has to be defined in program memory using the
+    /// LRCOLOR_STATIC() macro, the first entry is ignored. Off screen pixels are
+    /// ignored.
+    ///
+    /// @param spriteData Points to a PROGMEM array with the packed rows of the sprite.
+    /// @param width The width of the sprite (1-8).
+    /// @param height The height of the sprite. This is the number of rows.
+    /// @param x The X position of the top left corner of the sprite.
+    /// @param y The Y position of the top left corner of the sprite.
+    /// @param palette Points to a PROGMEM array with 4 colors.
+    /// @param blitMode How the sprite pixels are combined with the screen.
     ///
-    void drawSprite(const uint8_t *spriteData, const uint8_t spriteDataCount, const int8_t x, const int8_t y, const Color &color);
+    void drawSprite2bpp(const uint8_t *spriteData, const uint8_t width, const uint8_t height, const int8_t x, const int8_t y, const uint16_t *palette, const BlitMode blitMode = BlitReplace);
+    
+    /// Draw a sprite with 16 colors on the screen.
+    ///
+    /// The sprite has to be defined in program memory, using the LRSPRITE_4BPP_ROW()
+    /// macro for each row. Each pixel is an index into the palette, where index 0
+    /// is transparent. The palette has to be defined in program memory using the
+    /// LRCOLOR_STATIC() macro, the first entry is ignored. Off screen pixels are
+    /// ignored.
+    ///
+    /// @param spriteData Points to a PROGMEM array with the packed rows of the sprite.
+    /// @param width The width of the sprite (1-8).
+    /// @param height The height of the sprite. This is the number of rows.
+    /// @param x The X position of the top left corner of the sprite.
+    /// @param y The Y position of the top left corner of the sprite.
+    /// @param palette Points to a PROGMEM array with 16 colors.
+    /// @param blitMode How the sprite pixels are combined with the screen.
+    ///
+    void drawSprite4bpp(const uint8_t *spriteData, const uint8_t width, const uint8_t height, const int8_t x, const int8_t y, const uint16_t *palette, const BlitMode blitMode = BlitReplace);
     
     /// Scroll the current matrix in the given direction.
     ///
@@ -153,6 +486,52 @@ public:
     ///
     void fadePixel();
     
+    /// Fade pixels to black by a factor.
+    ///
+    /// Each color channel is multiplied with factor/16. All channels of
+    /// a byte are calculated at once.
+    ///
+    /// @param factor The factor for the colors (0-16). 16 keeps the colors, 0 is black.
+    ///
+    void fadePixel(uint8_t factor);
+    
+    /// Fade pixels one step toward a color.
+    ///
+    /// Each color channel is changed by one toward the channel of the color.
+    /// After 15 calls, all pixels have the given color.
+    ///
+    /// @param color The color to fade to.
+    ///
+    void fadePixelTo(const Color &color);
+    
+    /// Fade pixels one step toward the pixels of a canvas.
+    ///
+    /// Each color channel is changed by one toward the channel of the pixel
+    /// in the canvas. After 15 calls, the screen shows the canvas. The canvas
+    /// has to be 8x8 pixels, other canvas sizes are ignored.
+    ///
+    /// @param canvas The canvas to fade to.
+    ///
+    void fadePixelTo(const Canvas &canvas);
+    
+    /// Add the pixels of a canvas to the screen.
+    ///
+    /// Each color channel is added and limited to 15. The canvas has to be
+    /// 8x8 pixels, other canvas sizes are ignored.
+    ///
+    /// @param canvas The canvas with the pixels to add.
+    ///
+    void addPixels(const Canvas &canvas);
+    
+    /// Mix the pixels of a canvas with the screen.
+    ///
+    /// Each color channel is the average of the screen and the canvas. The
+    /// canvas has to be 8x8 pixels, other canvas sizes are ignored.
+    ///
+    /// @param canvas The canvas with the pixels to mix.
+    ///
+    void averagePixels(const Canvas &canvas);
+    
     /// Get the width of the matrix
     ///
     inline uint8_t getScreenWidth() const { return 8; }
@@ -161,8 +540,138 @@ public:
     ///
     inline uint8_t getScreenHeight() const { return 8; }
     
+    // --- Canvas Methods ---
+    
+    /// Show a part of a canvas on the display.
+    ///
+    /// The part of the canvas selected with the viewport is rendered into
+    /// the pixels each time the frame is presented, in frameSync() or in
+    /// present() with the DisplayExplicitPresent option. Scrolling is just
+    /// moving the viewport, draw into the canvas instead of the pixels.
+    /// A canvas can't be used with the DisplayPalette option.
+    ///
+    /// @param canvas The canvas to show, or 0 to stop using a canvas. The
+    ///   canvas object has to exist as long as it is used.
+    /// @param viewportMode How the viewport handles the edges of the canvas.
+    ///
+    void setCanvas(const Canvas *canvas, ViewportMode viewportMode = ViewportClamp);
+    
+    /// Set the position of the viewport in the canvas.
+    ///
+    /// In ViewportClamp mode, the position is limited to the canvas. In
+    /// ViewportWrap mode, the position wraps around.
+    ///
+    /// @param x The x position of the top left corner of the viewport.
+    /// @param y The y position of the top left corner of the viewport.
+    ///
+    void setViewport(int16_t x, int16_t y);
+    
+    /// Move the viewport relative to the current position.
+    ///
+    /// @param dx The number of pixels to move the viewport horizontally.
+    /// @param dy The number of pixels to move the viewport vertically.
+    ///
+    void moveViewport(int8_t dx, int8_t dy);
+    
+    /// Get the x position of the viewport.
+    ///
+    int16_t getViewportX() const;
+    
+    /// Get the y position of the viewport.
+    ///
+    int16_t getViewportY() const;
+    
+    // --- Mono Layer Methods ---
+    
+    /// Set the color of the mono layer.
+    ///
+    /// The mono layer is a 1 bit layer which is drawn over the pixels
+    /// by the display driver, using a single color. It is perfect for
+    /// text, digits or walls, because drawing just sets bits. The layer
+    /// is part of the presented frame: it is taken by the driver together
+    /// with the pixels, so with the DisplayExplicitPresent option, changes
+    /// of the layer are only shown after you called present(). With the BCM
+    /// driver, a new color is also shown with the next presented frame.
+    ///
+    /// @param color The color for all set pixels of the mono layer.
+    ///
+    void setMonoColor(const Color &color);
+    
+    /// Get the color of the mono layer.
+    ///
+    Color getMonoColor() const;
+    
+    /// Clear all pixels of the mono layer.
+    ///
+    void clearMono();
+    
+    /// Set or clear a pixel of the mono layer.
+    ///
+    /// @param x The x position of the pixel (0-7).
+    /// @param y The y position of the pixel (0-7).
+    /// @param enabled true to set the pixel, false to clear it.
+    ///
+    void setMonoPixel(int8_t x, int8_t y, bool enabled = true);
+    
+    /// Set or clear a pixel of the mono layer ignore off screen pixels.
+    ///
+    /// @param x The x position of the pixel (0-7).
+    /// @param y The y position of the pixel (0-7).
+    /// @param enabled true to set the pixel, false to clear it.
+    ///
+    void setMonoPixelS(int8_t x, int8_t y, bool enabled = true);
+    
+    /// Check if a pixel of the mono layer is set.
+    ///
+    /// @param x The x position of the pixel (0-7).
+    /// @param y The y position of the pixel (0-7).
+    /// @return true if the pixel is set.
+    ///
+    bool isMonoPixelSet(int8_t x, int8_t y) const;
+    
+    /// Set a whole row of the mono layer.
+    ///
+    /// @param y The y position of the row (0-7).
+    /// @param bits The bits for the row, highest bit on the left.
+    ///
+    void setMonoRow(int8_t y, uint8_t bits);
+    
+    /// Get a whole row of the mono layer.
+    ///
+    /// @param y The y position of the row (0-7).
+    /// @return The bits of the row, highest bit on the left.
+    ///
+    uint8_t getMonoRow(int8_t y) const;
+    
+    /// Draw a bitmap sprite into the mono layer.
+    ///
+    /// This works like drawSprite(), but each row of the sprite is
+    /// just shifted and combined with the row of the mono layer.
+    ///
+    /// @param spriteData Points to a PROGMEM array of bytes for the bitmap.
+    /// @param spriteDataCount The number of bytes in the array. This defines the height of the sprite.
+    /// @param x The X position of the top left corner of the sprite.
+    /// @param y The Y position of the top left corner of the sprite.
+    ///
+    void drawMonoSprite(const uint8_t *spriteData, const uint8_t spriteDataCount, const int8_t x, const int8_t y);
+    
     // --- Synchronization --
     
+    /// Mark the drawn pixels as complete.
+    ///
+    /// This is only used with the DisplayExplicitPresent option. The
+    /// pixels and the mono layer are taken with the next application frame.
+    /// Call frameSync() after this method, before you draw the next frame.
+    ///
+    void present();
+    
+    /// Check if the last frame was presented.
+    ///
+    /// @return true if the pixels were copied (or flipped) at the last
+    ///   frame synchronization, false if present() was not called in time.
+    ///
+    bool isFramePresented() const;
+    
     /// Wait for the display synchronization.
     ///
     /// This method waits for the display to synchronize and
@@ -175,6 +684,250 @@ public:
     ///
     uint32_t frameSync();
     
+    /// Check if a new frame started since the last synchronization.
+    ///
+    /// This method does not wait and does not prepare the pixels. It
+    /// returns true if the display synchronized since the last call of
+    /// frameSync() or a successful call of pollFrame().
+    ///
+    bool isFrameReady() const;
+    
+    /// Synchronize with the display without waiting.
+    ///
+    /// Use this method instead of frameSync() to do background work
+    /// in the time left in each frame. The first call after a frame
+    /// prepares the drawn pixels like frameSync() does, so call this
+    /// method only after the next frame is completely drawn:
+    ///
+    ///     if (meg.pollFrame()) {
+    ///         // logic and drawing for the next frame.
+    ///     } else {
+    ///         // short background work.
+    ///     }
+    ///
+    /// @return true if a new frame started, false if the display is
+    ///   still showing the current frame.
+    ///
+    bool pollFrame();
+    
+    /// Get the current frame number.
+    ///
+    /// This is the same value as returned by frameSync().
+    ///
+    uint32_t getFrame() const;
+    
+    /// Get the duration of an application frame.
+    ///
+    /// @return The duration in microseconds.
+    ///
+    uint32_t getFrameDuration() const;
+    
+    /// Get the duration of an application frame in CPU cycles.
+    ///
+    uint32_t getFrameCycles() const;
+    
+    /// Get the time used since the last frame synchronization.
+    ///
+    /// This is the time frameSyncShowLoad() displays, relative to
+    /// getFrameDuration(). It is measured with getCycleCount().
+    ///
+    /// @return The time in microseconds, or 0 before the first frame sync.
+    ///
+    uint32_t getFrameTime() const;
+    
+    /// Get the number of frames since the previous synchronization.
+    ///
+    /// This is 1 if the application kept up with the frame rate. If the
+    /// logic and drawing of the last frame took too long, the frame sync
+    /// waits for the next frame and this value is the number of frames
+    /// which passed (up to 255). Use this value to run fixed time step
+    /// logic like physics once per elapsed frame.
+    ///
+    uint8_t getElapsedFrames() const;
+    
+    /// Get the total number of missed frames.
+    ///
+    /// The counter is increased by getElapsedFrames()-1 at each frame
+    /// synchronization.
+    ///
+    uint32_t getMissedFrames() const;
+    
+    /// Get the highest number of frames missed at once.
+    ///
+    uint8_t getWorstOverrun() const;
+    
+    /// Reset the missed frame counter and the worst overrun.
+    ///
+    void resetMissedFrames();
+    
+    /// Reset the load histogram and the worst frame.
+    ///
+    void resetLoadHistogram();
+    
+    /// Get a bucket of the load histogram.
+    ///
+    /// At each frame sync, the time used since the last frame sync is
+    /// counted in one of 16 buckets. Bucket 0-14 each cover 1/15 of the
+    /// frame duration, bucket 15 counts the frames which took longer than
+    /// the frame duration. The counters stop at 65535.
+    ///
+    /// @param bucket The bucket (0-15).
+    /// @return The number of frames counted in the bucket.
+    ///
+    uint16_t getLoadHistogram(uint8_t bucket) const;
+    
+    /// Get the longest time used in a frame since the last reset.
+    ///
+    /// @return The time in microseconds.
+    ///
+    uint32_t getWorstFrameTime() const;
+    
+    /// Get the number of the frame which used the longest time.
+    ///
+    uint32_t getWorstFrame() const;
+    
+    /// Print the load histogram as a line of text.
+    ///
+    /// The line contains the frame duration, the worst frame time, the
+    /// worst frame number and the 16 buckets, separated by spaces:
+    /// "load <duration> <worst time> <worst frame> <bucket 0> ... <bucket 15>"
+    ///
+    /// @param output The output for the text, e.g. Serial.
+    ///
+    void printLoadHistogram(Print &output) const;
+    
+    /// Write the load histogram as a binary record.
+    ///
+    /// The record has LoadHistogramRecordSize bytes: The character 'L',
+    /// the number of buckets, the frame duration, the worst frame time and
+    /// the worst frame number as 32 bit values, the buckets as 16 bit values
+    /// and the 8 bit sum of all previous bytes. All values are little endian.
+    ///
+    /// @param output The output for the record, e.g. Serial.
+    ///
+    void writeLoadHistogram(Print &output) const;
+    
+    /// The size of the binary record written by writeLoadHistogram().
+    ///
+    static const uint8_t LoadHistogramRecordSize = 2 + 3*4 + 16*2 + 1;
+    
+    /// Get the number of CPU cycles since the setup.
+    ///
+    /// The value is derived from the display timer, so it does not use
+    /// timer 0 like micros() does, and it is cheap to read. Use it to
+    /// measure the time in your code. The resolution is 8 cycles with
+    /// the PWM driver and 64 cycles with the BCM driver. The value wraps
+    /// around after 2^32 cycles (about 4.5 minutes at 16MHz), so only
+    /// use the difference of two values.
+    ///
+    uint32_t getCycleCount() const;
+    
+    /// Enable or disable the measurement of the display interrupt.
+    ///
+    /// The timebase for getCycleCount() only adds the period to a counter
+    /// in the display interrupt. Measuring the time spent in the interrupt
+    /// adds a few more instructions to each of the ~15k interrupts per
+    /// second, so it is disabled by default. The Profiler enables it. The
+    /// setting is kept by setup(), so it can be enabled at any time.
+    ///
+    /// @param enabled true to measure the display interrupt.
+    ///
+    void setInterruptMeasurement(bool enabled);
+    
+    /// Check if the measurement of the display interrupt is enabled.
+    ///
+    bool isInterruptMeasurementEnabled() const;
+    
+    /// Get the number of CPU cycles spent in the display interrupt.
+    ///
+    /// Subtract the difference of this value from the difference of
+    /// getCycleCount() to get the cycles used by your code. The value
+    /// is measured at the end of each interrupt, so it does not include
+    /// the few cycles to return from the interrupt. It only increases
+    /// while the measurement is enabled with setInterruptMeasurement().
+    ///
+    uint32_t getInterruptCycleCount() const;
+    
+    /// Get both cycle counts at the same time.
+    ///
+    /// Both values are read with disabled interrupts, so a display
+    /// interrupt is either included in both values or in none. Use this
+    /// method to subtract the interrupt time from a measurement.
+    ///
+    /// @param cycles Set to the same value as getCycleCount().
+    /// @param interruptCycles Set to the same value as getInterruptCycleCount().
+    ///
+    void getCycleCounts(uint32_t &cycles, uint32_t &interruptCycles) const;
+    
+    /// Get the number of CPU cycles used outside of the display interrupt.
+    ///
+    /// This is the difference of both values from getCycleCounts(). Use
+    /// the difference of two values to measure a piece of code, without
+    /// the display interrupts in between. Enable the measurement with
+    /// setInterruptMeasurement() first, otherwise the interrupts are counted.
+    ///
+    uint32_t getCodeCycleCount() const;
+    
+    /// Get the number of CPU cycles of the longest display interrupt.
+    ///
+    /// The display interrupt has to finish within its period, which is
+    /// 1048 cycles with the PWM driver. A longer interrupt delays the
+    /// next one, which changes the brightness of a row and the timing.
+    /// In this case, the value is larger than the period. The resolution
+    /// is the same as for getCycleCount(). The value is only measured
+    /// while the measurement is enabled with setInterruptMeasurement().
+    ///
+    uint16_t getLongestInterruptCycles() const;
+    
+    /// Reset the longest display interrupt.
+    ///
+    void resetLongestInterrupt();
+    
+    /// The type for the idle callback.
+    ///
+    typedef void (*IdleCallback)();
+    
+    /// Set a callback which is called while waiting for the display.
+    ///
+    /// The frameSync() methods call this function repeatedly until
+    /// the display synchronizes. Keep the work in each call short,
+    /// a few hundred microseconds at most, so the frame sync is not
+    /// delayed. A callback which needs longer than the rest of the
+    /// frame causes the application to skip a frame.
+    ///
+    /// @param callback The function to call, or 0 to disable the callback.
+    ///
+    void setIdleCallback(IdleCallback callback);
+    
+    /// Enable or disable the idle sleep.
+    ///
+    /// If enabled, the frameSync() methods put the CPU into idle sleep
+    /// while waiting for the display, which reduces the power usage.
+    /// The timers keep running in idle sleep and the display interrupt
+    /// wakes the CPU at least once in each display period, so the frame
+    /// synchronization is delayed by a few cycles at most. An idle
+    /// callback is called once after each wake up.
+    ///
+    /// Idle sleep is disabled by default.
+    ///
+    /// @param enabled true to enable the idle sleep.
+    ///
+    void setIdleSleep(bool enabled);
+    
+    /// Check if the idle sleep is enabled.
+    ///
+    bool isIdleSleepEnabled() const;
+    
+    /// Get the time the CPU slept in the last frame.
+    ///
+    /// The time is measured with the display timer. The time spent in
+    /// interrupts while waiting is not counted as sleep.
+    ///
+    /// @return The time asleep relative to the frame duration (0-100%),
+    ///   0 if the idle sleep is disabled.
+    ///
+    uint8_t getSleepPercentage() const;
+    
     /// Wait for the display synchronization and show the load.
     ///
     /// This special version of the display synchronization works
@@ -189,6 +942,18 @@ public:
     ///
     uint32_t frameSyncShowLoad();
 
+    /// Wait for the display synchronization and show the sleep time.
+    ///
+    /// This special version of the display synchronization works
+    /// similar to the frameSyncShowLoad() method, but shows the time
+    /// the CPU slept in the last frame, as returned by getSleepPercentage().
+    /// 0 LEDs = 0%, 8 LEDs = 100%. Enable the idle sleep using
+    /// setIdleSleep() to see a value.
+    ///
+    /// Obviously, this method should only be used for testing.
+    ///
+    uint32_t frameSyncShowSleep();
+
     /// Wait for the display synchronization and show the free RAM.
     ///
     /// This special version of the display synchronization works
@@ -200,11 +965,54 @@ public:
     ///
     uint32_t frameSyncShowFreeRAM();
 
+    /// Wait for the display synchronization and show the peak stack usage.
+    ///
+    /// This special version of the display synchronization works like
+    /// frameSyncShowFreeRAM(), but shows the lowest free RAM since the
+    /// setup, as returned by getStackFree(). This includes the stack used
+    /// by interrupts and by deeply nested calls between two frames.
+    ///
+    /// Obviously, this method should only be used for testing.
+    ///
+    uint32_t frameSyncShowStack();
+    
+    /// Get the peak stack usage.
+    ///
+    /// The setup() method paints the unused RAM between the heap and the
+    /// stack with a pattern. Each frame sync checks a few bytes of this
+    /// area, and the lowest changed byte marks the peak stack usage. So
+    /// after a stack peak, it can take a few hundred frames until the
+    /// value is updated. Memory allocated on the heap after the setup
+    /// is counted as stack usage.
+    ///
+    /// @return The peak stack usage in bytes.
+    ///
+    uint16_t getStackUsage() const;
+    
+    /// Get the lowest free RAM between the heap and the stack since the setup.
+    ///
+    /// See getStackUsage() for details.
+    ///
+    /// @return The free RAM in bytes, 0 if the stack reached the heap.
+    ///
+    int16_t getStackFree() const;
+    
+    /// Print the peak stack usage and the lowest free RAM as a line of text.
+    ///
+    /// The line has the format "stack <usage> <free>".
+    ///
+    /// @param output The output for the text, e.g. Serial.
+    ///
+    void printStackUsage(Print &output) const;
+
     
     // --- Extra LED Methods ---
     
     /// Set the bits for the extra LEDs.
     ///
+    /// Each LED is either fully on or off. This removes the brightness
+    /// levels set with setExtraLedBrightness().
+    ///
     /// @param bits A bit mask to set all LEDs at once.
     ///
     void setExtraLeds(uint8_t bits);
@@ -234,6 +1042,34 @@ public:
     ///
     bool isExtraLedEnabled(uint8_t index) const;
     
+    /// Set the brightness of an extra LED.
+    ///
+    /// The extra LEDs are dimmed using the brightness levels of the display
+    /// driver, so they can be used as a smooth bar graph. The global
+    /// brightness of the display does not change the extra LEDs.
+    ///
+    /// @param index The index of the LED from 0 to 7.
+    /// @param brightness The brightness from 0 (off) to 15 (full on).
+    ///
+    void setExtraLedBrightness(uint8_t index, uint8_t brightness);
+    
+    /// Get the brightness of an extra LED.
+    ///
+    /// @param index The index of the LED from 0 to 7.
+    /// @return The brightness from 0 (off) to 15 (full on).
+    ///
+    uint8_t getExtraLedBrightness(uint8_t index) const;
+    
+    /// Show a value as a smooth bar on the extra LEDs.
+    ///
+    /// The bar starts at LED 0. The last LED of the bar is dimmed, so the
+    /// bar has 120 steps.
+    ///
+    /// @param value The value to show (0-maximum).
+    /// @param maximum The value for the full bar.
+    ///
+    void setExtraLedBar(uint8_t value, uint8_t maximum);
+    
     
     // --- Buttons ---
     
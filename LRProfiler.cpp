@@ -0,0 +1,156 @@
+//
+// Lucky Resistor's MeggyJr Profiler  
+// ---------------------------------------------------------------------------
+// (c)2014 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "LRProfiler.h"
+
+#include "LRMeggyJr.h"
+
+
+namespace lr {
+
+
+Profiler::Profiler(ProfilerSlot *slots, const uint8_t slotCount)
+    : _slots(slots), _slotCount(slotCount)
+{
+    memset(_slots, 0, sizeof(ProfilerSlot) * _slotCount);
+    meg.setInterruptMeasurement(true);
+}
+
+    
+void Profiler::setName(const uint8_t slot, const char *name)
+{
+    if (slot < _slotCount) {
+        _slots[slot].name = name;
+    }
+}
+
+    
+const char* Profiler::getName(const uint8_t slot) const
+{
+    if (slot >= _slotCount) {
+        return 0;
+    }
+    return _slots[slot].name;
+}
+
+    
+void Profiler::begin(const uint8_t slot)
+{
+    if (slot < _slotCount) {
+        ProfilerSlot &s = _slots[slot];
+        meg.getCycleCounts(s.startCycles, s.startInterruptCycles);
+    }
+}
+
+    
+void Profiler::end(const uint8_t slot)
+{
+    if (slot < _slotCount) {
+        uint32_t cycles;
+        uint32_t interruptCycles;
+        meg.getCycleCounts(cycles, interruptCycles);
+        ProfilerSlot &s = _slots[slot];
+        const uint32_t elapsed = cycles - s.startCycles;
+        const uint32_t stolen = interruptCycles - s.startInterruptCycles;
+        if (elapsed > stolen) {
+            s.frameCycles += elapsed - stolen;
+        }
+    }
+}
+
+    
+void Profiler::frame()
+{
+    for (uint8_t i = 0; i < _slotCount; ++i) {
+        ProfilerSlot &s = _slots[i];
+        s.lastFrameCycles = s.frameCycles;
+        if (s.frameCycles > s.maximumCycles) {
+            s.maximumCycles = s.frameCycles;
+        }
+        s.frameCycles = 0;
+    }
+}
+
+    
+uint32_t Profiler::getCycles(const uint8_t slot) const
+{
+    if (slot >= _slotCount) {
+        return 0;
+    }
+    return _slots[slot].lastFrameCycles;
+}
+
+    
+uint32_t Profiler::getMaximumCycles(const uint8_t slot) const
+{
+    if (slot >= _slotCount) {
+        return 0;
+    }
+    return _slots[slot].maximumCycles;
+}
+
+    
+uint8_t Profiler::getLoad(const uint8_t slot) const
+{
+    const uint32_t frameCycles = meg.getFrameCycles();
+    if (slot >= _slotCount) {
+        return 0;
+    }
+    const uint32_t load = _slots[slot].lastFrameCycles / (frameCycles / 100);
+    return (load > 0xFF) ? 0xFF : load;
+}
+
+    
+void Profiler::resetMaximum()
+{
+    for (uint8_t i = 0; i < _slotCount; ++i) {
+        _slots[i].maximumCycles = 0;
+    }
+}
+
+    
+void Profiler::showLoad(const uint8_t slot) const
+{
+    uint8_t leds = (getLoad(slot) * 8 + 50) / 100;
+    if (leds > 8) {
+        leds = 8;
+    }
+    meg.setExtraLeds(((uint16_t)1 << leds)-1);
+}
+
+    
+void Profiler::print(Print &output) const
+{
+    for (uint8_t i = 0; i < _slotCount; ++i) {
+        const ProfilerSlot &s = _slots[i];
+        output.print(s.name != 0 ? s.name : "-");
+        output.print(" ");
+        output.print(s.lastFrameCycles);
+        output.print(" ");
+        output.println(s.maximumCycles);
+    }
+}
+
+
+}
+
+
+// End of File
+// ----------------------------------------------------------------------------
+//
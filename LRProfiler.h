@@ -0,0 +1,189 @@
+#pragma once
+//
+// Lucky Resistor's MeggyJr Profiler  
+// ---------------------------------------------------------------------------
+// (c)2014 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+
+#include "Arduino.h"
+
+
+namespace lr {
+
+
+/// The data for one section of the profiler.
+///
+/// Create an array of these slots for the profiler. The size of the
+/// array sets the number of sections which can be measured.
+///
+struct ProfilerSlot {
+    const char *name; ///< The name of the section, or 0.
+    uint32_t startCycles; ///< The cycle count at begin().
+    uint32_t startInterruptCycles; ///< The interrupt cycle count at begin().
+    uint32_t frameCycles; ///< The cycles accumulated in the current frame.
+    uint32_t lastFrameCycles; ///< The cycles accumulated in the last frame.
+    uint32_t maximumCycles; ///< The most cycles accumulated in a frame.
+};
+
+
+/// A profiler to measure the time used by sections of your code.
+///
+/// The profiler uses the cycle counter of the display timer, so the
+/// resolution is 8 cycles with the PWM driver. The cycles spent in the
+/// display interrupt are subtracted from each measurement, so the
+/// profiler enables the interrupt measurement of the driver. Other
+/// interrupts, like the timer 0 interrupt, are counted.
+///
+/// Enclose each section of your code with begin() and end() for its
+/// slot, or use the LRPROFILE_SCOPE() macro. A section can be measured
+/// multiple times in a frame, the cycles are accumulated. Call frame()
+/// once after each frameSync() to finish the frame.
+///
+///     ProfilerSlot profilerSlots[2];
+///     Profiler profiler(profilerSlots, 2);
+///
+///     void loop() {
+///         meg.frameSync();
+///         profiler.frame();
+///         {
+///             LRPROFILE_SCOPE(profiler, 0);
+///             updateEnemies();
+///         }
+///         profiler.begin(1);
+///         drawLevel();
+///         profiler.end(1);
+///     }
+///
+class Profiler
+{
+public:
+    /// Create a new profiler.
+    ///
+    /// @param slots The array with the slots for the profiler.
+    /// @param slotCount The number of elements in the array.
+    ///
+    Profiler(ProfilerSlot *slots, const uint8_t slotCount);
+    
+public:
+    /// Set the name of a section.
+    ///
+    /// @param slot The slot of the section.
+    /// @param name The name of the section, which has to stay valid.
+    ///
+    void setName(const uint8_t slot, const char *name);
+    
+    /// Get the name of a section.
+    ///
+    /// @param slot The slot of the section.
+    /// @return The name of the section, or 0 if no name was set.
+    ///
+    const char* getName(const uint8_t slot) const;
+    
+    /// Start the measurement of a section.
+    ///
+    /// @param slot The slot of the section.
+    ///
+    void begin(const uint8_t slot);
+    
+    /// End the measurement of a section.
+    ///
+    /// @param slot The slot of the section.
+    ///
+    void end(const uint8_t slot);
+    
+    /// Finish the current frame.
+    ///
+    /// This keeps the cycles of all sections from the current frame
+    /// for getCycles() and starts with a new frame.
+    ///
+    void frame();
+    
+    /// Get the cycles used by a section in the last frame.
+    ///
+    /// @param slot The slot of the section.
+    ///
+    uint32_t getCycles(const uint8_t slot) const;
+    
+    /// Get the most cycles used by a section in a frame.
+    ///
+    /// @param slot The slot of the section.
+    ///
+    uint32_t getMaximumCycles(const uint8_t slot) const;
+    
+    /// Get the time used by a section in the last frame.
+    ///
+    /// @param slot The slot of the section.
+    /// @return The time relative to the frame duration (0-255%).
+    ///
+    uint8_t getLoad(const uint8_t slot) const;
+    
+    /// Reset the maximum cycles of all sections.
+    ///
+    void resetMaximum();
+    
+    /// Show the load of a section on the extra LEDs.
+    ///
+    /// Like frameSyncShowLoad(), 0 LEDs = 0% and 8 LEDs = 100%.
+    ///
+    /// @param slot The slot of the section.
+    ///
+    void showLoad(const uint8_t slot) const;
+    
+    /// Print the measured cycles of all sections.
+    ///
+    /// Prints one line for each section:
+    /// "<name> <cycles last frame> <maximum cycles>"
+    ///
+    /// @param output The output for the text, e.g. Serial.
+    ///
+    void print(Print &output) const;
+    
+private:
+    ProfilerSlot *_slots;
+    uint8_t _slotCount;
+};
+
+
+/// A helper to measure a scope with the profiler.
+///
+/// Use the LRPROFILE_SCOPE() macro to create an instance.
+///
+class ProfilerScope
+{
+public:
+    inline ProfilerScope(Profiler &profiler, const uint8_t slot)
+        : _profiler(profiler), _slot(slot) { _profiler.begin(_slot); }
+    inline ~ProfilerScope() { _profiler.end(_slot); }
+    
+private:
+    Profiler &_profiler;
+    uint8_t _slot;
+};
+
+
+/// Measure the rest of the current scope with the profiler.
+///
+/// Use this macro only once in each scope.
+///
+#define LRPROFILE_SCOPE(profiler, slot) lr::ProfilerScope _profilerScope(profiler, slot)
+
+
+}
+
+
@@ -0,0 +1,194 @@
+//
+// Lucky Resistor's MeggyJr Scheduler 
+// ---------------------------------------------------------------------------
+// (c)2014 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "LRScheduler.h"
+
+#include "LRMeggyJr.h"
+
+
+namespace lr {
+
+
+Scheduler::Scheduler(const uint8_t budget)
+{
+    for (uint8_t i = 0; i < MaxTasks; ++i) {
+        _tasks[i].function = 0;
+    }
+    setBudget(budget);
+}
+
+    
+uint8_t Scheduler::addTask(TaskFunction function, const uint8_t period, const uint8_t phase, const uint8_t priority)
+{
+    if (function == 0 || period == 0 || phase >= period) {
+        return InvalidTask;
+    }
+    for (uint8_t i = 0; i < MaxTasks; ++i) {
+        Task &task = _tasks[i];
+        if (task.function == 0) {
+            // Find the first frame after the current one in the right phase.
+            const uint32_t frame = meg.getFrame() + 1;
+            uint32_t nextFrame = frame - (frame % period) + phase;
+            if (nextFrame < frame) {
+                nextFrame += period;
+            }
+            task.function = function;
+            task.nextFrame = nextFrame;
+            task.period = period;
+            task.priority = priority;
+            task.pending = false;
+            task.deferredFrames = 0;
+            memset(&task.statistics, 0, sizeof(TaskStatistics));
+            return i;
+        }
+    }
+    return InvalidTask;
+}
+
+    
+void Scheduler::removeTask(const uint8_t task)
+{
+    if (task < MaxTasks) {
+        _tasks[task].function = 0;
+    }
+}
+
+    
+void Scheduler::setBudget(const uint8_t budget)
+{
+    if (budget == 0) {
+        _budget = 1;
+    } else if (budget > 100) {
+        _budget = 100;
+    } else {
+        _budget = budget;
+    }
+}
+
+    
+void Scheduler::run(const uint32_t frame)
+{
+    markDueTasks(frame);
+    const uint32_t budgetTime = meg.getFrameDuration() * _budget / 100;
+    bool firstTask = true;
+    uint8_t task;
+    while ((task = nextPendingTask(firstTask)) != InvalidTask) {
+        if (!firstTask) {
+            const uint32_t expectedTime = meg.getFrameTime() + _tasks[task].statistics.maximumDuration;
+            if (expectedTime > budgetTime) {
+                break;
+            }
+        }
+        runTask(task);
+        firstTask = false;
+    }
+    // Count the deferred tasks.
+    for (uint8_t i = 0; i < MaxTasks; ++i) {
+        Task &deferredTask = _tasks[i];
+        if (deferredTask.function != 0 && deferredTask.pending) {
+            if (deferredTask.deferredFrames < 0xFF) {
+                ++deferredTask.deferredFrames;
+            }
+            if (deferredTask.statistics.deferCount < 0xFFFF) {
+                ++deferredTask.statistics.deferCount;
+            }
+        }
+    }
+}
+
+    
+const Scheduler::TaskStatistics& Scheduler::getTaskStatistics(const uint8_t task) const
+{
+    return _tasks[task < MaxTasks ? task : 0].statistics;
+}
+
+    
+void Scheduler::resetStatistics()
+{
+    for (uint8_t i = 0; i < MaxTasks; ++i) {
+        memset(&_tasks[i].statistics, 0, sizeof(TaskStatistics));
+    }
+}
+
+    
+void Scheduler::markDueTasks(const uint32_t frame)
+{
+    for (uint8_t i = 0; i < MaxTasks; ++i) {
+        Task &task = _tasks[i];
+        if (task.function != 0 && (int32_t)(frame - task.nextFrame) >= 0) {
+            task.pending = true;
+            // Skip the periods missed by overrun frames.
+            const uint32_t late = frame - task.nextFrame;
+            task.nextFrame += (late / task.period + 1) * task.period;
+        }
+    }
+}
+
+    
+uint8_t Scheduler::nextPendingTask(const bool oldestFirst) const
+{
+    uint8_t result = InvalidTask;
+    for (uint8_t i = 0; i < MaxTasks; ++i) {
+        const Task &task = _tasks[i];
+        if (task.function != 0 && task.pending) {
+            if (result == InvalidTask) {
+                result = i;
+            } else if (oldestFirst && task.deferredFrames != _tasks[result].deferredFrames) {
+                // Aging, the task deferred for the most frames runs first.
+                if (task.deferredFrames > _tasks[result].deferredFrames) {
+                    result = i;
+                }
+            } else if (task.priority > _tasks[result].priority) {
+                result = i;
+            }
+        }
+    }
+    return result;
+}
+
+    
+void Scheduler::runTask(const uint8_t task)
+{
+    Task &t = _tasks[task];
+    t.pending = false;
+    t.deferredFrames = 0;
+    const uint32_t startCycles = meg.getCycleCount();
+    t.function();
+    uint32_t duration = (meg.getCycleCount() - startCycles) / (F_CPU / 1000000);
+    if (duration > 0xFFFF) {
+        duration = 0xFFFF;
+    }
+    TaskStatistics &statistics = t.statistics;
+    if (statistics.runCount < 0xFFFF) {
+        ++statistics.runCount;
+    }
+    statistics.lastDuration = duration;
+    if (duration > statistics.maximumDuration) {
+        statistics.maximumDuration = duration;
+    }
+    statistics.totalDuration += duration;
+}
+
+
+}
+
+
+// End of File
+// ----------------------------------------------------------------------------
+//
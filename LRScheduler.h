@@ -0,0 +1,154 @@
+#pragma once
+//
+// Lucky Resistor's MeggyJr Scheduler 
+// ---------------------------------------------------------------------------
+// (c)2014 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+
+#include "Arduino.h"
+
+
+namespace lr {
+
+
+/// A cooperative scheduler for tasks which run in sync with the frames.
+///
+/// Register each task with a period and a phase in frames, and call run()
+/// once after each frameSync(). A task runs in all frames where the frame
+/// number modulo the period equals the phase. If several tasks are due, the
+/// task with the highest priority runs first.
+///
+/// The scheduler measures the time with the cycle counter of the display
+/// timer, like frameSyncShowLoad() does. A due task which would not finish within
+/// the budget, based on its longest measured run, is deferred to the next
+/// frame. The first task in each frame always runs. This slot goes to the
+/// task which was deferred for the most frames, before the priority is
+/// considered. So even with a high priority task in every frame, a
+/// deferred task runs at the latest after MaxTasks frames.
+///
+/// Each task uses 22 bytes of SRAM, so the capacity is limited to MaxTasks.
+///
+class Scheduler
+{
+public:
+    /// The function for a task.
+    ///
+    typedef void (*TaskFunction)();
+    
+    /// The statistics for a task.
+    ///
+    struct TaskStatistics {
+        uint16_t runCount; ///< The number of runs.
+        uint16_t deferCount; ///< The number of times the task was deferred.
+        uint16_t lastDuration; ///< The duration of the last run in microseconds.
+        uint16_t maximumDuration; ///< The longest run in microseconds.
+        uint32_t totalDuration; ///< The total duration of all runs in microseconds.
+    };
+    
+    /// The maximum number of tasks.
+    ///
+    static const uint8_t MaxTasks = 8;
+    
+    /// The identifier returned if a task can not be added.
+    ///
+    static const uint8_t InvalidTask = 0xFF;
+    
+public:
+    /// Create a new scheduler without tasks.
+    ///
+    /// @param budget The part of the frame the tasks may use in percent (1-100).
+    ///
+    Scheduler(const uint8_t budget = 80);
+    
+public:
+    /// Add a new task.
+    ///
+    /// @param function The function to call.
+    /// @param period The period of the task in frames (1-255).
+    /// @param phase The frame in the period where the task runs (0 to period-1).
+    /// @param priority The priority of the task, tasks with higher values run first.
+    /// @return The identifier of the task, or InvalidTask if all slots are used.
+    ///
+    uint8_t addTask(TaskFunction function, const uint8_t period, const uint8_t phase = 0, const uint8_t priority = 0);
+    
+    /// Remove a task.
+    ///
+    /// @param task The identifier of the task.
+    ///
+    void removeTask(const uint8_t task);
+    
+    /// Set the budget for the tasks.
+    ///
+    /// @param budget The part of the frame the tasks may use in percent (1-100).
+    ///
+    void setBudget(const uint8_t budget);
+    
+    /// Run all due tasks.
+    ///
+    /// Call this method once after each frameSync(), with the
+    /// returned frame number.
+    ///
+    /// @param frame The current frame number.
+    ///
+    void run(const uint32_t frame);
+    
+    /// Get the statistics for a task.
+    ///
+    /// @param task The identifier of the task.
+    ///
+    const TaskStatistics& getTaskStatistics(const uint8_t task) const;
+    
+    /// Reset the statistics for all tasks.
+    ///
+    void resetStatistics();
+    
+private:
+    /// Mark all tasks as pending which are due in the given frame.
+    ///
+    void markDueTasks(const uint32_t frame);
+    
+    /// Get the pending task with the highest priority.
+    ///
+    /// @param oldestFirst true to prefer the task deferred for the most frames.
+    /// @return The index of the task, or InvalidTask if no task is pending.
+    ///
+    uint8_t nextPendingTask(const bool oldestFirst) const;
+    
+    /// Run a task and update the statistics.
+    ///
+    void runTask(const uint8_t task);
+    
+private:
+    struct Task {
+        TaskFunction function;
+        uint32_t nextFrame;
+        uint8_t period;
+        uint8_t priority;
+        bool pending;
+        uint8_t deferredFrames;
+        TaskStatistics statistics;
+    };
+    Task _tasks[MaxTasks];
+    uint8_t _budget;
+};
+
+
+}
+
+
@@ -0,0 +1,93 @@
+#pragma once
+//
+// Lucky Resistor's MeggyJr Sprite
+// ---------------------------------------------------------------------------
+// (c)2014 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "Arduino.h"
+
+
+namespace lr {
+
+
+/// Get the palette index of a character in a sprite row.
+///
+/// The characters '1'-'9' and 'A'-'F' are the indexes 1-15. Every other
+/// character, like '.' or ' ', is the transparent index 0. Pixels after
+/// the end of the row are transparent too.
+///
+template<size_t N>
+constexpr uint8_t spritePixelIndex(const char (&row)[N], const uint8_t i)
+{
+    return (i >= N-1) ? 0 :
+        (row[i] >= '1' && row[i] <= '9') ? (row[i] - '0') :
+        (row[i] >= 'A' && row[i] <= 'F') ? (row[i] - 'A' + 10) : 0;
+}
+
+    
+/// Pack four pixels of a sprite row into one byte with 2 bits for each pixel.
+///
+template<size_t N>
+constexpr uint8_t spritePack2bpp(const char (&row)[N], const uint8_t byteIndex)
+{
+    return (uint8_t)(((spritePixelIndex(row, byteIndex*4+0) & 0x3) << 6) |
+        ((spritePixelIndex(row, byteIndex*4+1) & 0x3) << 4) |
+        ((spritePixelIndex(row, byteIndex*4+2) & 0x3) << 2) |
+        (spritePixelIndex(row, byteIndex*4+3) & 0x3));
+}
+
+    
+/// Pack two pixels of a sprite row into one byte with 4 bits for each pixel.
+///
+template<size_t N>
+constexpr uint8_t spritePack4bpp(const char (&row)[N], const uint8_t byteIndex)
+{
+    return (uint8_t)((spritePixelIndex(row, byteIndex*2+0) << 4) |
+        spritePixelIndex(row, byteIndex*2+1));
+}
+
+    
+/// Use this macro to define a row of a sprite with 4 colors.
+///
+/// Each character is one pixel, with '.' for transparent pixels and '1'-'3'
+/// for the colors from the palette. A row has up to 8 pixels and is packed
+/// into 2 bytes at compile time:
+///
+///     const uint8_t sprite[] PROGMEM = {
+///         LRSPRITE_2BPP_ROW(".1221."),
+///         LRSPRITE_2BPP_ROW("123321"),
+///         LRSPRITE_2BPP_ROW(".1221."),
+///     };
+///
+#define LRSPRITE_2BPP_ROW(row) lr::spritePack2bpp(row, 0), lr::spritePack2bpp(row, 1)
+
+
+/// Use this macro to define a row of a sprite with 16 colors.
+///
+/// Each character is one pixel, with '.' for transparent pixels and '1'-'9',
+/// 'A'-'F' for the colors from the palette. A row has up to 8 pixels and is
+/// packed into 4 bytes at compile time.
+///
+#define LRSPRITE_4BPP_ROW(row) lr::spritePack4bpp(row, 0), lr::spritePack4bpp(row, 1), \
+    lr::spritePack4bpp(row, 2), lr::spritePack4bpp(row, 3)
+
+
+}
+
+
@@ -0,0 +1,174 @@
+//
+// Lucky Resistor's MeggyJr Tile Map
+// ---------------------------------------------------------------------------
+// (c)2014 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "LRTileMap.h"
+
+#include "LRMeggyJr.h"
+
+
+namespace lr {
+
+
+TileMap::TileMap(const uint8_t *mapData, const uint8_t mapWidth, const uint8_t mapHeight, const uint16_t *tileData, const TileSize tileSize)
+    : _mapData(mapData), _tileData(tileData), _mapWidth(mapWidth), _mapHeight(mapHeight), _tileSize(tileSize),
+    _cameraX(0), _cameraY(0), _renderedX(0), _renderedY(0), _rendered(false), _renderedPixels(0), _renderDuration(0)
+{
+}
+
+    
+void TileMap::setCamera(int16_t x, int16_t y)
+{
+    _cameraX = x;
+    _cameraY = y;
+}
+
+    
+void TileMap::moveCamera(int8_t dx, int8_t dy)
+{
+    _cameraX += dx;
+    _cameraY += dy;
+}
+
+    
+void TileMap::update()
+{
+    const uint32_t startCycles = meg.getCycleCount();
+    const int16_t dx = _cameraX - _renderedX;
+    const int16_t dy = _cameraY - _renderedY;
+    // The index image of the palette mode can't be scrolled.
+    if (!_rendered || dx < -1 || dx > 1 || dy < -1 || dy > 1 ||
+        (meg.getDisplayOptions() & MeggyJr::DisplayPalette) != 0) {
+        render();
+        return;
+    }
+    _renderedPixels = 0;
+    // Scroll the pixels and render the new column. The column is rendered
+    // for the previous y position, because it is scrolled vertically below.
+    if (dx == 1) {
+        meg.scrollPixel(MeggyJr::ScrollLeft);
+        renderColumn(meg.getScreenWidth()-1, _renderedY);
+    } else if (dx == -1) {
+        meg.scrollPixel(MeggyJr::ScrollRight);
+        renderColumn(0, _renderedY);
+    }
+    // Scroll the pixels and render the new row.
+    if (dy == 1) {
+        meg.scrollPixel(MeggyJr::ScrollUp);
+        renderRow(meg.getScreenHeight()-1);
+    } else if (dy == -1) {
+        meg.scrollPixel(MeggyJr::ScrollDown);
+        renderRow(0);
+    }
+    _renderedX = _cameraX;
+    _renderedY = _cameraY;
+    _renderDuration = (meg.getCycleCount() - startCycles) / (F_CPU / 1000000);
+}
+
+    
+void TileMap::render()
+{
+    const uint32_t startCycles = meg.getCycleCount();
+    _renderedPixels = 0;
+    for (uint8_t x = 0; x < meg.getScreenWidth(); ++x) {
+        renderColumn(x, _cameraY);
+    }
+    _renderedX = _cameraX;
+    _renderedY = _cameraY;
+    _rendered = true;
+    _renderDuration = (meg.getCycleCount() - startCycles) / (F_CPU / 1000000);
+}
+
+    
+uint8_t TileMap::getTile(int16_t x, int16_t y) const
+{
+    if (x>=0 && y>=0 && x<_mapWidth && y<_mapHeight) {
+        return pgm_read_byte(_mapData + (uint16_t)y*_mapWidth + x);
+    } else {
+        return 0;
+    }
+}
+
+    
+Color TileMap::getMapPixel(int16_t x, int16_t y) const
+{
+    return Color(getMapValue(x, y));
+}
+
+    
+uint8_t TileMap::getMapPixelIndex(int16_t x, int16_t y) const
+{
+    return getMapValue(x, y) & 0x0F;
+}
+
+    
+uint16_t TileMap::getMapValue(int16_t x, int16_t y) const
+{
+    if (x < 0 || y < 0) {
+        return 0;
+    }
+    if (_tileSize == TileSize1x1) {
+        if (x >= _mapWidth || y >= _mapHeight) {
+            return 0;
+        }
+        return pgm_read_word(_tileData + getTile(x, y));
+    } else {
+        const int16_t tx = x >> 1;
+        const int16_t ty = y >> 1;
+        if (tx >= _mapWidth || ty >= _mapHeight) {
+            return 0;
+        }
+        const uint16_t offset = ((uint16_t)getTile(tx, ty) << 2) | ((y & 1) << 1) | (x & 1);
+        return pgm_read_word(_tileData + offset);
+    }
+}
+
+    
+void TileMap::setDisplayPixel(uint8_t x, uint8_t y, uint16_t value) const
+{
+    if ((meg.getDisplayOptions() & MeggyJr::DisplayPalette) != 0) {
+        meg.setPixelIndex(x, y, value & 0x0F);
+    } else {
+        meg.setPixel(x, y, Color(value));
+    }
+}
+
+    
+void TileMap::renderColumn(uint8_t x, int16_t cameraY)
+{
+    for (uint8_t y = 0; y < meg.getScreenHeight(); ++y) {
+        setDisplayPixel(x, y, getMapValue(_cameraX + x, cameraY + y));
+    }
+    _renderedPixels += meg.getScreenHeight();
+}
+
+    
+void TileMap::renderRow(uint8_t y)
+{
+    for (uint8_t x = 0; x < meg.getScreenWidth(); ++x) {
+        setDisplayPixel(x, y, getMapValue(_cameraX + x, _cameraY + y));
+    }
+    _renderedPixels += meg.getScreenWidth();
+}
+
+
+}
+
+// End of File
+// ----------------------------------------------------------------------------
+//
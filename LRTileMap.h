@@ -0,0 +1,179 @@
+#pragma once
+//
+// Lucky Resistor's MeggyJr Tile Map
+// ---------------------------------------------------------------------------
+// (c)2014 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "Arduino.h"
+
+#include "LRColor.h"
+
+
+namespace lr {
+
+
+/// A tile map which renders a level from program memory.
+///
+/// The map is an array of tile indexes in PROGMEM, stored row by row.
+/// The tile set is an array of colors in PROGMEM, defined with the
+/// LRCOLOR_STATIC() macro. A tile has either 1x1 pixels (one color for each
+/// tile) or 2x2 pixels (four colors for each tile, row by row).
+///
+/// The camera defines the position of the top left pixel of the display
+/// in the map. If the camera moved by a single pixel since the last
+/// update, the pixels on the display are scrolled and only the new column
+/// or row is rendered. For this to work, nothing else may be drawn into
+/// the pixels. Draw the player or other objects into the mono layer, or
+/// call render() to render the whole display.
+///
+/// With the DisplayPalette option, the tile set contains palette indexes
+/// (0-15) instead of colors, and the pixels are drawn with setPixelIndex().
+/// The index image can't be scrolled, so update() renders the whole
+/// display in this mode.
+///
+class TileMap
+{
+public:
+    /// The size of the tiles.
+    enum TileSize : uint8_t {
+        TileSize1x1 = 1, // Each tile has one pixel.
+        TileSize2x2 = 2  // Each tile has 2x2 pixels.
+    };
+    
+public:
+    /// Create a new tile map.
+    ///
+    /// @param mapData The tile indexes in PROGMEM, row by row.
+    /// @param mapWidth The width of the map in tiles.
+    /// @param mapHeight The height of the map in tiles.
+    /// @param tileData The colors of the tiles in PROGMEM.
+    /// @param tileSize The size of the tiles.
+    ///
+    TileMap(const uint8_t *mapData, const uint8_t mapWidth, const uint8_t mapHeight, const uint16_t *tileData, const TileSize tileSize);
+    
+public:
+    /// Set the camera position.
+    ///
+    /// @param x The x position of the top left display pixel in the map (in pixels).
+    /// @param y The y position of the top left display pixel in the map (in pixels).
+    ///
+    void setCamera(int16_t x, int16_t y);
+    
+    /// Move the camera.
+    ///
+    /// @param dx The number of pixels to move the camera horizontally.
+    /// @param dy The number of pixels to move the camera vertically.
+    ///
+    void moveCamera(int8_t dx, int8_t dy);
+    
+    /// Get the x position of the camera.
+    ///
+    inline int16_t getCameraX() const { return _cameraX; }
+    
+    /// Get the y position of the camera.
+    ///
+    inline int16_t getCameraY() const { return _cameraY; }
+    
+    /// Render the changes since the last update.
+    ///
+    /// If the camera moved by one pixel, the display is scrolled and only
+    /// the new column or row is rendered. Otherwise the whole display is
+    /// rendered. Call this method once each frame, after moving the camera.
+    ///
+    void update();
+    
+    /// Render the whole display.
+    ///
+    void render();
+    
+    /// Get the tile at the given position.
+    ///
+    /// @param x The x position of the tile.
+    /// @param y The y position of the tile.
+    /// @return The index of the tile or 0 if the position is outside of the map.
+    ///
+    uint8_t getTile(int16_t x, int16_t y) const;
+    
+    /// Get the color of a pixel in the map.
+    ///
+    /// @param x The x position of the pixel in the map.
+    /// @param y The y position of the pixel in the map.
+    /// @return The color of the pixel or black if the position is outside of the map.
+    ///
+    Color getMapPixel(int16_t x, int16_t y) const;
+    
+    /// Get the palette index of a pixel in the map.
+    ///
+    /// This is only used with a tile set of palette indexes.
+    ///
+    /// @param x The x position of the pixel in the map.
+    /// @param y The y position of the pixel in the map.
+    /// @return The index of the pixel or 0 if the position is outside of the map.
+    ///
+    uint8_t getMapPixelIndex(int16_t x, int16_t y) const;
+    
+    /// Get the time of the last update in microseconds.
+    ///
+    inline uint16_t getRenderDuration() const { return _renderDuration; }
+    
+    /// Get the number of pixels rendered at the last update.
+    ///
+    inline uint8_t getRenderedPixels() const { return _renderedPixels; }
+    
+private:
+    /// Get the entry of the tile set for a pixel in the map.
+    ///
+    /// @return The entry of the tile set or 0 if the position is outside of the map.
+    ///
+    uint16_t getMapValue(int16_t x, int16_t y) const;
+    
+    /// Set a pixel on the display to an entry of the tile set.
+    ///
+    void setDisplayPixel(uint8_t x, uint8_t y, uint16_t value) const;
+    
+    /// Render one column of the display.
+    ///
+    /// @param x The column of the display.
+    /// @param cameraY The y position of the camera to render the column for.
+    ///
+    void renderColumn(uint8_t x, int16_t cameraY);
+    
+    /// Render one row of the display.
+    ///
+    void renderRow(uint8_t y);
+
+private:
+    const uint8_t *_mapData;
+    const uint16_t *_tileData;
+    uint8_t _mapWidth;
+    uint8_t _mapHeight;
+    TileSize _tileSize;
+    int16_t _cameraX;
+    int16_t _cameraY;
+    int16_t _renderedX;
+    int16_t _renderedY;
+    bool _rendered;
+    uint8_t _renderedPixels;
+    uint16_t _renderDuration;
+};
+
+
+}
+
+
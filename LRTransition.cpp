@@ -0,0 +1,136 @@
+//
+// Lucky Resistor's MeggyJr Transition
+// ---------------------------------------------------------------------------
+// (c)2014 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "LRTransition.h"
+
+#include "LRMeggyJr.h"
+
+
+namespace lr {
+
+
+namespace {
+
+// The number of pixels changed by each step of the dissolve transition.
+const uint8_t dissolvePixelsPerStep = 4;
+
+// The multiplier for the dissolve order. Any odd number visits all
+// 64 pixels exactly once, this one gives a random looking pattern.
+const uint8_t dissolveMultiplier = 37;
+
+}
+
+
+Transition::Transition()
+    : _target(0), _type(Wipe), _framesPerStep(1), _frameCounter(0), _step(0), _stepCount(1)
+{
+}
+
+    
+bool Transition::start(const Canvas *target, const Type type, const uint8_t framesPerStep)
+{
+    if (target == 0 || target->getWidth() != meg.getScreenWidth() || target->getHeight() != meg.getScreenHeight()) {
+        _target = 0;
+        return false;
+    }
+    _target = target;
+    _type = type;
+    _framesPerStep = (framesPerStep > 0) ? framesPerStep : 1;
+    _frameCounter = 0;
+    _step = 0;
+    switch (type) {
+        case Dissolve:
+            _stepCount = 64 / dissolvePixelsPerStep;
+            break;
+            
+        case CrossFade:
+            _stepCount = 15;
+            break;
+            
+        default:
+            _stepCount = meg.getScreenWidth();
+            break;
+    }
+    return true;
+}
+
+    
+void Transition::update()
+{
+    if (_target == 0) {
+        return;
+    }
+    // With page flip, the pixels to draw hold the previously shown frame.
+    // Keep them in sync with the screen, also between the steps.
+    meg.copyDisplayedPixels();
+    if (++_frameCounter < _framesPerStep) {
+        return;
+    }
+    _frameCounter = 0;
+    switch (_type) {
+        case Wipe:
+            copyColumn(_step, _step);
+            break;
+            
+        case Dissolve:
+            for (uint8_t i = 0; i < dissolvePixelsPerStep; ++i) {
+                const uint8_t pixel = ((_step * dissolvePixelsPerStep + i) * dissolveMultiplier) & 0x3F;
+                const uint8_t x = pixel >> 3;
+                const uint8_t y = pixel & 0x7;
+                meg.setPixel(x, y, _target->getPixel(x, y));
+            }
+            break;
+            
+        case Slide:
+            meg.scrollPixel(MeggyJr::ScrollLeft);
+            copyColumn(_step, meg.getScreenWidth()-1);
+            break;
+            
+        case CrossFade:
+            meg.fadePixelTo(*_target);
+            break;
+    }
+    if (++_step >= _stepCount) {
+        _target = 0;
+    }
+}
+
+    
+uint8_t Transition::getProgress() const
+{
+    if (_target == 0) {
+        return 100;
+    }
+    return (uint16_t)_step * 100 / _stepCount;
+}
+
+    
+void Transition::copyColumn(uint8_t sourceX, uint8_t targetX)
+{
+    for (uint8_t y = 0; y < meg.getScreenHeight(); ++y) {
+        meg.setPixel(targetX, y, _target->getPixel(sourceX, y));
+    }
+}
+
+
+}
+
+// End of File
+// ----------------------------------------------------------------------------
+//
@@ -0,0 +1,105 @@
+#pragma once
+//
+// Lucky Resistor's MeggyJr Transition
+// ---------------------------------------------------------------------------
+// (c)2014 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "Arduino.h"
+
+#include "LRCanvas.h"
+
+
+namespace lr {
+
+
+/// A transition from the pixels on the screen to an image in a canvas.
+///
+/// The transition is split into small steps, and each call of update()
+/// does at most one step. So the transition never blows the frame budget
+/// and the game logic keeps running while it is in progress.
+///
+/// The target is a canvas with 8x8 pixels. It can be in SRAM or in
+/// program memory. A canvas in SRAM can be changed during the transition.
+/// Do not draw into the pixels while the transition is running.
+///
+/// With the DisplayPageFlip option, update() copies the displayed pixels
+/// into the pixels you draw in each frame, so every step continues from
+/// the image on the screen.
+///
+class Transition
+{
+public:
+    /// The type of the transition.
+    enum Type : uint8_t {
+        Wipe      = 0x0, // The target is uncovered column by column from the left.
+        Dissolve  = 0x1, // The target replaces the pixels in a random looking order.
+        Slide     = 0x2, // The screen slides out to the left, while the target slides in.
+        CrossFade = 0x3  // The color channels fade from the screen to the target.
+    };
+    
+public:
+    /// Create a new transition which is not running.
+    ///
+    Transition();
+    
+public:
+    /// Start a transition.
+    ///
+    /// @param target The canvas with the target image (8x8 pixels).
+    /// @param type The type of the transition.
+    /// @param framesPerStep The number of frames for each step, to slow down the transition.
+    /// @return true if the transition started, false if the target is not 8x8 pixels.
+    ///
+    bool start(const Canvas *target, const Type type, const uint8_t framesPerStep = 1);
+    
+    /// Do the next step of the transition.
+    ///
+    /// Call this method once after each frameSync(), also in the frames
+    /// between the steps. It does nothing if the transition is not running.
+    ///
+    void update();
+    
+    /// Check if the transition is running.
+    ///
+    inline bool isRunning() const { return _target != 0; }
+    
+    /// Get the progress of the transition.
+    ///
+    /// @return The progress in percent (0-100).
+    ///
+    uint8_t getProgress() const;
+    
+private:
+    /// Copy a column from the target to the screen.
+    ///
+    void copyColumn(uint8_t sourceX, uint8_t targetX);
+    
+private:
+    const Canvas *_target;
+    Type _type;
+    uint8_t _framesPerStep;
+    uint8_t _frameCounter;
+    uint8_t _step;
+    uint8_t _stepCount;
+};
+
+
+}
+
+
@@ -0,0 +1,183 @@
+//
+// Blend Benchmark
+// ---------------------------------------------------------------------------
+// (c)2014 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+
+#include <LRMeggyJr.h>
+
+
+using namespace lr;
+
+
+// A second image to blend with the screen.
+uint8_t imageData[LRCANVAS_SIZE(8, 8)];
+Canvas image(imageData, 8, 8);
+
+// The result of the reference implementation.
+uint16_t referenceResult[64];
+
+
+// Draw the test pattern on the screen and into the image.
+void drawTestPattern()
+{
+    for (uint8_t x = 0; x < 8; ++x) {
+        for (uint8_t y = 0; y < 8; ++y) {
+            meg.setPixel(x, y, Color(x*2, y*2, (x+y)));
+            image.setPixel(x, y, Color(15-y*2, x, 7));
+        }
+    }
+}
+
+
+// The reference implementations, which calculate each channel of each pixel.
+uint8_t referenceScale(uint8_t value, uint8_t factor) { return (value * factor) >> 4; }
+uint8_t referenceStep(uint8_t value, uint8_t target) { return (value < target) ? value+1 : ((value > target) ? value-1 : value); }
+uint8_t referenceAdd(uint8_t a, uint8_t b) { return (a + b > 15) ? 15 : (a + b); }
+uint8_t referenceAverage(uint8_t a, uint8_t b) { return (a + b) >> 1; }
+
+void referenceFadePixel(uint8_t factor)
+{
+    for (uint8_t x = 0; x < 8; ++x) {
+        for (uint8_t y = 0; y < 8; ++y) {
+            const Color c = meg.getPixel(x, y);
+            referenceResult[x*8+y] = LRCOLOR_STATIC(referenceScale(c.getRed(), factor), referenceScale(c.getGreen(), factor), referenceScale(c.getBlue(), factor));
+        }
+    }
+}
+
+void referenceFadePixelTo(const Color &target)
+{
+    for (uint8_t x = 0; x < 8; ++x) {
+        for (uint8_t y = 0; y < 8; ++y) {
+            const Color c = meg.getPixel(x, y);
+            referenceResult[x*8+y] = LRCOLOR_STATIC(referenceStep(c.getRed(), target.getRed()), referenceStep(c.getGreen(), target.getGreen()), referenceStep(c.getBlue(), target.getBlue()));
+        }
+    }
+}
+
+void referenceAddPixels()
+{
+    for (uint8_t x = 0; x < 8; ++x) {
+        for (uint8_t y = 0; y < 8; ++y) {
+            const Color a = meg.getPixel(x, y);
+            const Color b = image.getPixel(x, y);
+            referenceResult[x*8+y] = LRCOLOR_STATIC(referenceAdd(a.getRed(), b.getRed()), referenceAdd(a.getGreen(), b.getGreen()), referenceAdd(a.getBlue(), b.getBlue()));
+        }
+    }
+}
+
+void referenceAveragePixels()
+{
+    for (uint8_t x = 0; x < 8; ++x) {
+        for (uint8_t y = 0; y < 8; ++y) {
+            const Color a = meg.getPixel(x, y);
+            const Color b = image.getPixel(x, y);
+            referenceResult[x*8+y] = LRCOLOR_STATIC(referenceAverage(a.getRed(), b.getRed()), referenceAverage(a.getGreen(), b.getGreen()), referenceAverage(a.getBlue(), b.getBlue()));
+        }
+    }
+}
+
+
+// Compare the screen with the reference result.
+bool isEqualToReference()
+{
+    for (uint8_t x = 0; x < 8; ++x) {
+        for (uint8_t y = 0; y < 8; ++y) {
+            const Color c = meg.getPixel(x, y);
+            if (LRCOLOR_STATIC(c.getRed(), c.getGreen(), c.getBlue()) != referenceResult[x*8+y]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+// Print one line of the result.
+void printResult(const char *name, uint32_t referenceCycles, uint32_t kernelCycles)
+{
+    Serial.print(name);
+    Serial.print(" reference: ");
+    Serial.print(referenceCycles);
+    Serial.print(" cycles, kernel: ");
+    Serial.print(kernelCycles);
+    Serial.print(" cycles, ");
+    Serial.println(isEqualToReference() ? "equal" : "DIFFERENT");
+}
+
+
+// The setup code.
+void setup()
+{
+    meg.setup();
+    // Measure the display interrupt, so it is not counted for the code.
+    meg.setInterruptMeasurement(true);
+    Serial.begin(115200);
+}
+
+
+// The loop code.
+void loop()
+{
+    uint32_t start;
+    uint32_t referenceCycles;
+    uint32_t kernelCycles;
+    
+    // The cycles are measured with the display timer, in steps of 8 cycles.
+    
+    drawTestPattern();
+    start = meg.getCodeCycleCount();
+    referenceFadePixel(11);
+    referenceCycles = meg.getCodeCycleCount() - start;
+    start = meg.getCodeCycleCount();
+    meg.fadePixel(11);
+    kernelCycles = meg.getCodeCycleCount() - start;
+    printResult("Fade by factor", referenceCycles, kernelCycles);
+    
+    drawTestPattern();
+    start = meg.getCodeCycleCount();
+    referenceFadePixelTo(Color::violet());
+    referenceCycles = meg.getCodeCycleCount() - start;
+    start = meg.getCodeCycleCount();
+    meg.fadePixelTo(Color::violet());
+    kernelCycles = meg.getCodeCycleCount() - start;
+    printResult("Fade to color", referenceCycles, kernelCycles);
+    
+    drawTestPattern();
+    start = meg.getCodeCycleCount();
+    referenceAddPixels();
+    referenceCycles = meg.getCodeCycleCount() - start;
+    start = meg.getCodeCycleCount();
+    meg.addPixels(image);
+    kernelCycles = meg.getCodeCycleCount() - start;
+    printResult("Add", referenceCycles, kernelCycles);
+    
+    drawTestPattern();
+    start = meg.getCodeCycleCount();
+    referenceAveragePixels();
+    referenceCycles = meg.getCodeCycleCount() - start;
+    start = meg.getCodeCycleCount();
+    meg.averagePixels(image);
+    kernelCycles = meg.getCodeCycleCount() - start;
+    printResult("Average", referenceCycles, kernelCycles);
+    
+    Serial.println();
+    delay(2000);
+}
@@ -0,0 +1,97 @@
+//
+// Blit Benchmark
+// ---------------------------------------------------------------------------
+// (c)2014 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+
+#include <LRMeggyJr.h>
+
+
+using namespace lr;
+
+
+// A small ship sprite.
+const uint8_t ship[] PROGMEM = {
+    B00100000,
+    B01110000,
+    B11111000,
+    B01010000,
+};
+
+
+// The position of the ship.
+int8_t shipX = 0;
+int8_t shipY = 2;
+
+
+// Draw the background, like the examples do for each frame.
+void drawBackground()
+{
+    meg.fillRect(0, 6, 8, 2, Color::darkGreen());
+    meg.fillRect(2, 0, 1, 6, Color::darkBlue());
+    meg.fillRect(6, 0, 1, 6, Color::darkBlue());
+}
+
+
+// The setup code.
+void setup()
+{
+    meg.setup();
+    // Measure the display interrupt, so it is not counted for the code.
+    meg.setInterruptMeasurement(true);
+    Serial.begin(115200);
+    meg.clearPixels();
+    drawBackground();
+    meg.drawSprite(ship, 4, shipX, shipY, Color::yellow(), MeggyJr::BlitXor);
+}
+
+
+// The loop code.
+void loop()
+{
+    meg.frameSync();
+    const int8_t newShipX = (shipX + 1) & 0x7;
+    
+    // Move the ship by clearing the screen and drawing everything again.
+    // The cycles are measured with the display timer, in steps of 8 cycles.
+    uint32_t start = meg.getCodeCycleCount();
+    meg.clearPixels();
+    drawBackground();
+    meg.drawSprite(ship, 4, newShipX, shipY, Color::yellow());
+    const uint32_t redrawCycles = meg.getCodeCycleCount() - start;
+    
+    // Restore the previous frame to compare with the same start.
+    meg.clearPixels();
+    drawBackground();
+    meg.drawSprite(ship, 4, shipX, shipY, Color::yellow(), MeggyJr::BlitXor);
+    
+    // Move the ship by erasing and drawing it with XOR.
+    start = meg.getCodeCycleCount();
+    meg.drawSprite(ship, 4, shipX, shipY, Color::yellow(), MeggyJr::BlitXor);
+    meg.drawSprite(ship, 4, newShipX, shipY, Color::yellow(), MeggyJr::BlitXor);
+    const uint32_t xorCycles = meg.getCodeCycleCount() - start;
+    shipX = newShipX;
+    
+    Serial.print("Clear and redraw: ");
+    Serial.print(redrawCycles);
+    Serial.print(" cycles, XOR erase and draw: ");
+    Serial.print(xorCycles);
+    Serial.println(" cycles");
+    delay(500);
+}
@@ -0,0 +1,73 @@
+//
+// Canvas Demo
+// ---------------------------------------------------------------------------
+// (c)2014 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+
+#include <LRMeggyJr.h>
+
+
+using namespace lr;
+
+
+// The data for a 16x16 canvas.
+uint8_t canvasData[LRCANVAS_SIZE(16, 16)];
+
+// The canvas.
+Canvas canvas(canvasData, 16, 16);
+
+
+// The setup code.
+void setup() 
+{
+    meg.setup();
+    
+    // Draw a checker board with a frame into the canvas.
+    for (uint8_t x = 0; x < 16; ++x) {
+        for (uint8_t y = 0; y < 16; ++y) {
+            if (x == 0 || y == 0 || x == 15 || y == 15) {
+                canvas.setPixel(x, y, Color::red());
+            } else if (((x ^ y) & 2) != 0) {
+                canvas.setPixel(x, y, Color::darkBlue());
+            }
+        }
+    }
+    meg.setCanvas(&canvas, MeggyJr::ViewportWrap);
+}
+
+
+// The loop code.
+void loop()
+{
+    meg.frameSyncShowLoad();
+    
+    // Scrolling is just moving the viewport.
+    if (meg.isLeftButtonDown()) {
+        meg.moveViewport(-1, 0);
+    }
+    if (meg.isRightButtonDown()) {
+        meg.moveViewport(1, 0);
+    }
+    if (meg.isUpButtonDown()) {
+        meg.moveViewport(0, -1);
+    }
+    if (meg.isDownButtonDown()) {
+        meg.moveViewport(0, 1);
+    }
+}
@@ -0,0 +1,100 @@
+//
+// Driver Benchmark
+// ---------------------------------------------------------------------------
+// (c)2014 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include <LRMeggyJr.h>
+
+
+using namespace lr;
+
+
+// Select the display driver to measure.
+// Use MeggyJr::DisplayDefault for the PWM driver or MeggyJr::DisplayBCM for the BCM driver.
+const uint8_t displayOptions = MeggyJr::DisplayDefault;
+
+// The number of display interrupts per second for the selected driver.
+const uint32_t interruptsPerSecond = ((displayOptions & MeggyJr::DisplayBCM) != 0) ?
+    (F_CPU / 64 / (F_CPU / 64 / 8 / 15 / 120) / 15 * 4) : // 8 rows x 4 slots at ~122Hz
+    (8UL * 16 * 120); // 8 rows x 16 levels at 120Hz
+
+
+// Count how often a simple loop runs in one second.
+uint32_t countIterations()
+{
+    uint32_t count = 0;
+    const uint32_t start = micros();
+    while (micros() - start < 1000000) {
+        ++count;
+    }
+    return count;
+}
+
+
+// The setup code.
+void setup()
+{
+    meg.setup(MeggyJr::FrameRate30, displayOptions);
+    meg.setInterruptMeasurement(true);
+    Serial.begin(115200);
+    
+    // Draw a test pattern, so all nibbles have different values.
+    for (int8_t x = 0; x < 8; ++x) {
+        for (int8_t y = 0; y < 8; ++y) {
+            meg.setPixel(x, y, Color(x*2, y*2, (x+y)));
+        }
+    }
+}
+
+
+// The loop code.
+void loop()
+{
+    // Measure with the display interrupt. The driver also measures
+    // the time spent in each of its interrupts.
+    meg.resetLongestInterrupt();
+    const uint32_t startInterruptCycles = meg.getInterruptCycleCount();
+    const uint32_t withDriver = countIterations();
+    const uint32_t interruptCycles = meg.getInterruptCycleCount() - startInterruptCycles;
+    const uint16_t longestCycles = meg.getLongestInterruptCycles();
+    
+    // Measure again without the display interrupt. The display
+    // freezes while the reference value is measured.
+    TIMSK2 = 0;
+    const uint32_t withoutDriver = countIterations();
+    TIMSK2 = _BV(OCIE2A);
+    
+    // Calculate the load in 1/1000 and the cycles for each interrupt.
+    const uint32_t load = (withoutDriver - withDriver) * 1000 / withoutDriver;
+    const uint32_t cycles = (F_CPU / 1000) * load / interruptsPerSecond;
+    
+    Serial.print(((displayOptions & MeggyJr::DisplayBCM) != 0) ? "BCM" : "PWM");
+    Serial.print(" load: ");
+    Serial.print(load / 10);
+    Serial.print(".");
+    Serial.print(load % 10);
+    Serial.print("% interrupts/s: ");
+    Serial.print(interruptsPerSecond);
+    Serial.print(" cycles/interrupt: ");
+    Serial.print(cycles);
+    Serial.print(" measured cycles/interrupt: ");
+    Serial.print(interruptCycles / interruptsPerSecond);
+    Serial.print(" longest: ");
+    Serial.println(longestCycles);
+}
@@ -0,0 +1,120 @@
+//
+// Fill Benchmark
+// ---------------------------------------------------------------------------
+// (c)2014 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+
+#include <LRMeggyJr.h>
+
+
+using namespace lr;
+
+
+// The previous implementation of fillRect(), which sets every pixel.
+void fillRectPerPixel(int8_t x, int8_t y, uint8_t width, uint8_t height, const Color &color)
+{
+    for (int8_t xd = 0; xd < width; ++xd) {
+        for (int8_t yd = 0; yd < height; ++yd) {
+            meg.setPixel(x+xd, y+yd, color);
+        }
+    }
+}
+
+
+// Print one line of the result.
+void printResult(const char *name, uint32_t perPixelCycles, uint32_t spanCycles)
+{
+    Serial.print(name);
+    Serial.print(" per pixel: ");
+    Serial.print(perPixelCycles);
+    Serial.print(" cycles, spans: ");
+    Serial.print(spanCycles);
+    Serial.println(" cycles");
+}
+
+
+// The setup code.
+void setup()
+{
+    meg.setup();
+    // Measure the display interrupt, so it is not counted for the code.
+    meg.setInterruptMeasurement(true);
+    Serial.begin(115200);
+}
+
+
+// The loop code.
+void loop()
+{
+    const Color color(3, 7, 11);
+    uint32_t start;
+    uint32_t perPixelCycles;
+    uint32_t spanCycles;
+    
+    // The cycles are measured with the display timer, in steps of 8 cycles.
+    
+    // Fill the whole screen.
+    start = meg.getCodeCycleCount();
+    fillRectPerPixel(0, 0, 8, 8, color);
+    perPixelCycles = meg.getCodeCycleCount() - start;
+    start = meg.getCodeCycleCount();
+    meg.fillRect(0, 0, 8, 8, color);
+    spanCycles = meg.getCodeCycleCount() - start;
+    printResult("8x8 rectangle", perPixelCycles, spanCycles);
+    
+    // A small rectangle with odd position and size.
+    start = meg.getCodeCycleCount();
+    fillRectPerPixel(2, 3, 3, 3, color);
+    perPixelCycles = meg.getCodeCycleCount() - start;
+    start = meg.getCodeCycleCount();
+    meg.fillRect(2, 3, 3, 3, color);
+    spanCycles = meg.getCodeCycleCount() - start;
+    printResult("3x3 rectangle", perPixelCycles, spanCycles);
+    
+    // A small rectangle with even position and size.
+    start = meg.getCodeCycleCount();
+    fillRectPerPixel(4, 2, 2, 4, color);
+    perPixelCycles = meg.getCodeCycleCount() - start;
+    start = meg.getCodeCycleCount();
+    meg.fillRect(4, 2, 2, 4, color);
+    spanCycles = meg.getCodeCycleCount() - start;
+    printResult("2x4 rectangle", perPixelCycles, spanCycles);
+    
+    // One full column.
+    start = meg.getCodeCycleCount();
+    fillRectPerPixel(5, 0, 1, 8, color);
+    perPixelCycles = meg.getCodeCycleCount() - start;
+    start = meg.getCodeCycleCount();
+    meg.fillColumn(5, color);
+    spanCycles = meg.getCodeCycleCount() - start;
+    printResult("Column", perPixelCycles, spanCycles);
+    
+    // One full row.
+    start = meg.getCodeCycleCount();
+    fillRectPerPixel(0, 5, 8, 1, color);
+    perPixelCycles = meg.getCodeCycleCount() - start;
+    start = meg.getCodeCycleCount();
+    meg.fillHorizontalSpan(0, 5, 8, color);
+    spanCycles = meg.getCodeCycleCount() - start;
+    printResult("Row", perPixelCycles, spanCycles);
+    
+    Serial.println();
+    meg.clearPixels();
+    delay(2000);
+}
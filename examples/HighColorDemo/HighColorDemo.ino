@@ -0,0 +1,76 @@
+//
+// High Color Demo
+// ---------------------------------------------------------------------------
+// (c)2014 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+
+#include <LRMeggyJr.h>
+
+
+using namespace lr;
+
+
+// The brightness of the fade (0-63).
+uint8_t level = 0;
+
+// The direction of the fade.
+int8_t direction = 1;
+
+
+// The setup code.
+void setup() 
+{
+    meg.setup(MeggyJr::FrameRate30, MeggyJr::DisplayHighColor);
+    meg.setInterruptMeasurement(true);
+    Serial.begin(115200);
+}
+
+
+// The loop code.
+void loop()
+{
+    meg.frameSync();
+    
+    // The top half shows a dark gradient with 32 steps,
+    // which has only 8 steps with 16 brightness levels.
+    for (uint8_t x = 0; x < 8; ++x) {
+        for (uint8_t y = 0; y < 4; ++y) {
+            meg.setPixelHighColor(x, y, 0, 0, y*8 + x);
+        }
+    }
+    
+    // The bottom half slowly fades in and out.
+    for (uint8_t x = 0; x < 8; ++x) {
+        for (uint8_t y = 4; y < 8; ++y) {
+            meg.setPixelHighColor(x, y, level, level >> 2, 0);
+        }
+    }
+    level += direction;
+    if (level == 0 || level == 63) {
+        direction = -direction;
+    }
+    
+    // Press A to print the longest display interrupt.
+    if (meg.isAButtonPressed()) {
+        Serial.print("Longest interrupt: ");
+        Serial.print(meg.getLongestInterruptCycles());
+        Serial.println(" cycles");
+        meg.resetLongestInterrupt();
+    }
+}
@@ -0,0 +1,93 @@
+//
+// Idle Work Demo 
+// ---------------------------------------------------------------------------
+// (c)2014 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+
+
+#include <LRMeggyJr.h>
+
+
+using namespace lr;
+
+
+// The next number to test for a prime number.
+uint16_t candidate = 3;
+
+// The number of found prime numbers.
+uint16_t primeCount = 1;
+
+// The number of background work steps in the last frame.
+uint16_t workSteps = 0;
+
+
+// Do one short step of background work.
+// This tests one odd number if it is a prime number.
+void backgroundWork()
+{
+    if (candidate < 3) { // Wrapped around.
+        candidate = 3;
+        primeCount = 1;
+    }
+    bool isPrime = true;
+    for (uint16_t divisor = 3; (uint32_t)divisor * divisor <= candidate; divisor += 2) {
+        if (candidate % divisor == 0) {
+            isPrime = false;
+            break;
+        }
+    }
+    if (isPrime) {
+        ++primeCount;
+    }
+    candidate += 2;
+    ++workSteps;
+}
+
+
+// The setup code.
+void setup() 
+{
+    meg.setup(MeggyJr::FrameRate30);
+}
+
+
+// The loop code.
+void loop()
+{
+    if (!meg.pollFrame()) {
+        // The display is still showing the current frame.
+        backgroundWork();
+        return;
+    }
+    
+    // Show the number of work steps done in the last frame.
+    meg.clearPixels();
+    uint16_t bar = workSteps / 8;
+    if (bar > 64) {
+        bar = 64;
+    }
+    for (uint8_t i = 0; i < bar; ++i) {
+        meg.setPixel(i & 7, i >> 3, Color::green());
+    }
+    workSteps = 0;
+    
+    // Show the lower bits of the prime count on the extra LEDs.
+    meg.setExtraLeds(primeCount & 0xFF);
+}
+
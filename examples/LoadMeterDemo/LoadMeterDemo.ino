@@ -29,6 +29,7 @@ using namespace lr;
 void setup() 
 {
     meg.setup();
+    Serial.begin(115200);
 }
 
 
@@ -37,6 +38,15 @@ void loop()
 {
     const uint32_t frame = meg.frameSyncShowLoad();
     
+    // Press A to print the load histogram and the stack usage, press B to reset the histogram.
+    if (meg.isAButtonPressed()) {
+        meg.printLoadHistogram(Serial);
+        meg.printStackUsage(Serial);
+    }
+    if (meg.isBButtonPressed()) {
+        meg.resetLoadHistogram();
+    }
+    
     meg.clearPixels();
     
     if ((frame & B01000000) == 0) {
@@ -0,0 +1,56 @@
+//
+// Palette Cycle Demo
+// ---------------------------------------------------------------------------
+// (c)2014 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+
+#include <LRMeggyJr.h>
+
+
+using namespace lr;
+
+
+// The setup code.
+void setup() 
+{
+    meg.setup(MeggyJr::FrameRate30, MeggyJr::DisplayPalette);
+    
+    // Draw rings with the palette indexes 1-4.
+    for (int8_t x = 0; x < 8; ++x) {
+        for (int8_t y = 0; y < 8; ++y) {
+            const int8_t dx = (x < 4) ? (3-x) : (x-4);
+            const int8_t dy = (y < 4) ? (3-y) : (y-4);
+            meg.setPixelIndex(x, y, ((dx > dy) ? dx : dy) + 1);
+        }
+    }
+}
+
+
+// The loop code.
+void loop()
+{
+    meg.frameSync();
+    
+    // Rotate the colors 1-4, the pixels are never touched.
+    const Color first = meg.getPaletteColor(1);
+    for (uint8_t i = 1; i < 4; ++i) {
+        meg.setPaletteColor(i, meg.getPaletteColor(i+1));
+    }
+    meg.setPaletteColor(4, first);
+}
@@ -0,0 +1,89 @@
+//
+// High Color Demo
+// ---------------------------------------------------------------------------
+// (c)2014 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+
+
+#include <LRMeggyJr.h>
+
+
+using namespace lr;
+
+
+// The slots for the measured sections.
+enum Section : uint8_t {
+    SectionLogic,
+    SectionDrawing,
+    SectionCount
+};
+
+// The profiler.
+ProfilerSlot profilerSlots[SectionCount];
+Profiler profiler(profilerSlots, SectionCount);
+
+// The section shown on the extra LEDs.
+uint8_t shownSection = SectionLogic;
+
+// The simulated work.
+uint8_t work = 0;
+
+
+// The setup code.
+void setup() 
+{
+    meg.setup();
+    Serial.begin(115200);
+    profiler.setName(SectionLogic, "logic");
+    profiler.setName(SectionDrawing, "drawing");
+}
+
+
+// The loop code.
+void loop()
+{
+    const uint32_t frame = meg.frameSync();
+    profiler.frame();
+    profiler.showLoad(shownSection);
+    
+    {
+        LRPROFILE_SCOPE(profiler, SectionLogic);
+        // Press left/right to select the shown section, A to print the results.
+        if (meg.isLeftButtonPressed()) {
+            shownSection = SectionLogic;
+        }
+        if (meg.isRightButtonPressed()) {
+            shownSection = SectionDrawing;
+        }
+        if (meg.isAButtonPressed()) {
+            profiler.print(Serial);
+        }
+        // ONLY FOR DEMONSTRATION! Simulate some work.
+        work = (frame >> 2) & 0x3F;
+        delayMicroseconds((uint16_t)work * 100);
+    }
+    
+    profiler.begin(SectionDrawing);
+    meg.clearPixels();
+    for (uint8_t i = 0; i < work; ++i) {
+        meg.setPixel(i & 7, i >> 3, Color::blue());
+    }
+    profiler.end(SectionDrawing);
+}
+
@@ -0,0 +1,112 @@
+//
+// High Color Demo
+// ---------------------------------------------------------------------------
+// (c)2014 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+
+
+#include <LRMeggyJr.h>
+
+
+using namespace lr;
+
+
+// A short sound cue.
+const SoundToken PROGMEM cue[] = {
+    PlaySpeed200,
+    NoteC5, Play16,
+    NoteG5, Play16,
+    SoundEnd
+};
+
+// The scheduler for all tasks.
+Scheduler scheduler;
+
+// The position and speed of the ball.
+int8_t ballX = 0;
+int8_t ballY = 3;
+int8_t ballDX = 1;
+int8_t ballDY = 1;
+
+// The position of the chaser.
+uint8_t chaserX = 7;
+uint8_t chaserY = 7;
+
+
+// Move the ball, every frame.
+void updatePhysics()
+{
+    if (ballX + ballDX < 0 || ballX + ballDX > 7) {
+        ballDX = -ballDX;
+    }
+    if (ballY + ballDY < 0 || ballY + ballDY > 7) {
+        ballDY = -ballDY;
+    }
+    ballX += ballDX;
+    ballY += ballDY;
+}
+
+
+// Move the chaser one step towards the ball, every fourth frame.
+void updateChaser()
+{
+    if (chaserX < ballX) {
+        ++chaserX;
+    } else if (chaserX > ballX) {
+        --chaserX;
+    }
+    if (chaserY < ballY) {
+        ++chaserY;
+    } else if (chaserY > ballY) {
+        --chaserY;
+    }
+}
+
+
+// Play a short sound, every two seconds.
+void playCue()
+{
+    meg.playSound(cue);
+}
+
+
+// The setup code.
+void setup() 
+{
+    meg.setup(MeggyJr::FrameRate15);
+    scheduler.addTask(updatePhysics, 1, 0, 2);
+    scheduler.addTask(updateChaser, 4, 1, 1);
+    scheduler.addTask(playCue, 30, 0, 0);
+}
+
+
+// The loop code.
+void loop()
+{
+    const uint32_t frame = meg.frameSync();
+    scheduler.run(frame);
+    
+    meg.clearPixels();
+    meg.setPixel(ballX, ballY, Color::green());
+    meg.setPixel(chaserX, chaserY, Color::red());
+    
+    // Show the longest run of the chaser task in microseconds on the extra LEDs.
+    meg.setExtraLeds(scheduler.getTaskStatistics(1).maximumDuration);
+}
+
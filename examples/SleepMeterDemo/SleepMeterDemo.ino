@@ -0,0 +1,56 @@
+//
+// High Color Demo
+// ---------------------------------------------------------------------------
+// (c)2014 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+
+
+#include <LRMeggyJr.h>
+
+
+using namespace lr;
+
+
+// The setup code.
+void setup() 
+{
+    meg.setup();
+    meg.setIdleSleep(true);
+}
+
+
+// The loop code.
+void loop() 
+{
+    // The extra LEDs show how much of the frame time the CPU slept.
+    const uint32_t frame = meg.frameSyncShowSleep();
+    
+    // Press A to toggle the idle sleep.
+    if (meg.isAButtonPressed()) {
+        meg.setIdleSleep(!meg.isIdleSleepEnabled());
+    }
+    
+    meg.clearPixels();
+    meg.setPixel(frame&0x7, (frame>>3)&0x7, meg.isIdleSleepEnabled() ? Color::green() : Color::red());
+    
+    // ONLY FOR DEMONSTRATION!
+    // This is creating an increasing load, which reduces the sleep time.
+    delay((frame>>3)&0x0F);
+}
+
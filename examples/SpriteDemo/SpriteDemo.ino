@@ -0,0 +1,125 @@
+//
+// Sprite Demo
+// ---------------------------------------------------------------------------
+// (c)2014 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+
+#include <LRMeggyJr.h>
+
+
+using namespace lr;
+
+
+// A ghost with 4 colors.
+const uint8_t ghost[] PROGMEM = {
+    LRSPRITE_2BPP_ROW(".1111."),
+    LRSPRITE_2BPP_ROW("111111"),
+    LRSPRITE_2BPP_ROW("123123"),
+    LRSPRITE_2BPP_ROW("111111"),
+    LRSPRITE_2BPP_ROW("111111"),
+    LRSPRITE_2BPP_ROW("1.11.1"),
+};
+
+// The colors of the ghost. The first entry is transparent.
+const uint16_t ghostPalette[] PROGMEM = {
+    LRCOLOR_STATIC(0, 0, 0),
+    LRCOLOR_STATIC(15, 0, 4),
+    LRCOLOR_STATIC(15, 15, 15),
+    LRCOLOR_STATIC(0, 0, 15),
+};
+
+// A rainbow ball with 16 colors.
+const uint8_t ball[] PROGMEM = {
+    LRSPRITE_4BPP_ROW(".123."),
+    LRSPRITE_4BPP_ROW("45678"),
+    LRSPRITE_4BPP_ROW("9ABCD"),
+    LRSPRITE_4BPP_ROW("EF123"),
+    LRSPRITE_4BPP_ROW(".456."),
+};
+
+// The colors of the ball. The first entry is transparent.
+const uint16_t ballPalette[] PROGMEM = {
+    LRCOLOR_STATIC(0, 0, 0),
+    LRCOLOR_STATIC(15, 0, 0),
+    LRCOLOR_STATIC(15, 4, 0),
+    LRCOLOR_STATIC(15, 10, 0),
+    LRCOLOR_STATIC(10, 15, 0),
+    LRCOLOR_STATIC(4, 15, 0),
+    LRCOLOR_STATIC(0, 15, 0),
+    LRCOLOR_STATIC(0, 15, 4),
+    LRCOLOR_STATIC(0, 15, 10),
+    LRCOLOR_STATIC(0, 10, 15),
+    LRCOLOR_STATIC(0, 4, 15),
+    LRCOLOR_STATIC(0, 0, 15),
+    LRCOLOR_STATIC(4, 0, 15),
+    LRCOLOR_STATIC(10, 0, 15),
+    LRCOLOR_STATIC(15, 0, 10),
+    LRCOLOR_STATIC(15, 0, 4),
+};
+
+// The position of the ghost.
+int8_t ghostX = 1;
+int8_t ghostY = 1;
+
+// The position and direction of the ball.
+int8_t ballX = 0;
+int8_t ballDirection = 1;
+uint8_t ballDelay = 0;
+
+
+// The setup code.
+void setup() 
+{
+    meg.setup();
+}
+
+
+// The loop code.
+void loop()
+{
+    meg.frameSync();
+    
+    // Move the ghost with the buttons.
+    if (meg.isLeftButtonPressed()) {
+        --ghostX;
+    }
+    if (meg.isRightButtonPressed()) {
+        ++ghostX;
+    }
+    if (meg.isUpButtonPressed()) {
+        --ghostY;
+    }
+    if (meg.isDownButtonPressed()) {
+        ++ghostY;
+    }
+    
+    // Move the ball from one side to the other.
+    if (++ballDelay == 8) {
+        ballDelay = 0;
+        ballX += ballDirection;
+        if (ballX <= -5 || ballX >= 8) {
+            ballDirection = -ballDirection;
+        }
+    }
+    
+    // Draw the sprites. The clipping is done by the sprite methods.
+    meg.clearPixels();
+    meg.drawSprite4bpp(ball, 5, 5, ballX, 3, ballPalette);
+    meg.drawSprite2bpp(ghost, 6, 6, ghostX, ghostY, ghostPalette);
+}
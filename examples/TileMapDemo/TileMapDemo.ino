@@ -0,0 +1,108 @@
+//
+// Tile Map Demo
+// ---------------------------------------------------------------------------
+// (c)2014 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+
+#include <LRMeggyJr.h>
+
+
+using namespace lr;
+
+
+// The tile set with 2x2 pixels for each tile.
+const uint16_t tileSet[] PROGMEM = {
+    // 0: Sky
+    LRCOLOR_STATIC(0, 0, 1), LRCOLOR_STATIC(0, 0, 1),
+    LRCOLOR_STATIC(0, 0, 1), LRCOLOR_STATIC(0, 0, 1),
+    // 1: Ground
+    LRCOLOR_STATIC(0, 6, 0), LRCOLOR_STATIC(0, 6, 0),
+    LRCOLOR_STATIC(3, 1, 0), LRCOLOR_STATIC(3, 1, 0),
+    // 2: Earth
+    LRCOLOR_STATIC(3, 1, 0), LRCOLOR_STATIC(2, 1, 0),
+    LRCOLOR_STATIC(2, 1, 0), LRCOLOR_STATIC(3, 1, 0),
+    // 3: Brick
+    LRCOLOR_STATIC(8, 2, 0), LRCOLOR_STATIC(5, 1, 0),
+    LRCOLOR_STATIC(5, 1, 0), LRCOLOR_STATIC(8, 2, 0),
+    // 4: Coin
+    LRCOLOR_STATIC(0, 0, 1), LRCOLOR_STATIC(15, 12, 0),
+    LRCOLOR_STATIC(15, 12, 0), LRCOLOR_STATIC(0, 0, 1),
+};
+
+// The level with 16x6 tiles.
+const uint8_t levelWidth = 16;
+const uint8_t levelHeight = 6;
+const uint8_t level[] PROGMEM = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 4, 0, 0, 0, 0, 0, 4, 4, 0, 0, 0, 0, 0,
+    0, 0, 3, 3, 3, 0, 0, 0, 3, 3, 3, 3, 0, 0, 4, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 3, 3, 3,
+    1, 1, 1, 1, 1, 1, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+    2, 2, 2, 2, 2, 2, 0, 0, 2, 2, 2, 2, 2, 2, 2, 2,
+};
+
+// The tile map.
+TileMap tileMap(level, levelWidth, levelHeight, tileSet, TileMap::TileSize2x2);
+
+
+// The setup code.
+void setup() 
+{
+    meg.setup();
+    Serial.begin(115200);
+    tileMap.setCamera(0, 4);
+    tileMap.render();
+    
+    // The player is drawn in the mono layer, so the tile map
+    // can be scrolled incrementally.
+    meg.setMonoPixel(3, 3);
+}
+
+
+// The loop code.
+void loop()
+{
+    meg.frameSync();
+    
+    // Move the camera within the level.
+    const int16_t maxX = levelWidth * 2 - meg.getScreenWidth();
+    const int16_t maxY = levelHeight * 2 - meg.getScreenHeight();
+    if (meg.isLeftButtonDown() && tileMap.getCameraX() > 0) {
+        tileMap.moveCamera(-1, 0);
+    }
+    if (meg.isRightButtonDown() && tileMap.getCameraX() < maxX) {
+        tileMap.moveCamera(1, 0);
+    }
+    if (meg.isUpButtonDown() && tileMap.getCameraY() > 0) {
+        tileMap.moveCamera(0, -1);
+    }
+    if (meg.isDownButtonDown() && tileMap.getCameraY() < maxY) {
+        tileMap.moveCamera(0, 1);
+    }
+    tileMap.update();
+    
+    // Report the render cost of this frame.
+    if (meg.isAButtonPressed()) {
+        Serial.print("Rendered pixels: ");
+        Serial.print(tileMap.getRenderedPixels());
+        Serial.print(" in ");
+        Serial.print(tileMap.getRenderDuration());
+        Serial.println("us");
+    }
+}
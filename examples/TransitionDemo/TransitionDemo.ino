@@ -0,0 +1,78 @@
+//
+// Transition Demo
+// ---------------------------------------------------------------------------
+// (c)2014 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+
+#include <LRMeggyJr.h>
+
+
+using namespace lr;
+
+
+// The two images to switch between.
+uint8_t imageData[2][LRCANVAS_SIZE(8, 8)];
+Canvas images[2] = {
+    Canvas(imageData[0], 8, 8),
+    Canvas(imageData[1], 8, 8)
+};
+
+// The transition.
+Transition transition;
+
+// The image which is shown.
+uint8_t shownImage = 0;
+
+// The next transition type.
+uint8_t nextType = Transition::Wipe;
+
+
+// The setup code.
+void setup() 
+{
+    meg.setup();
+    
+    // A red and yellow image and a blue and green image.
+    for (uint8_t x = 0; x < 8; ++x) {
+        for (uint8_t y = 0; y < 8; ++y) {
+            images[0].setPixel(x, y, ((x ^ y) & 1) ? Color::red() : Color::darkYellow());
+            images[1].setPixel(x, y, (x < y) ? Color::blue() : Color::darkGreen());
+        }
+    }
+    transition.start(&images[0], Transition::Wipe);
+}
+
+
+// The loop code.
+void loop()
+{
+    meg.frameSync();
+    transition.update();
+    
+    // Start the next transition with the A button.
+    if (meg.isAButtonPressed() && !transition.isRunning()) {
+        shownImage ^= 1;
+        transition.start(&images[shownImage], (Transition::Type)nextType, 4);
+        nextType = (nextType + 1) & 0x3;
+    }
+    
+    // The game logic keeps running, here it shows the progress.
+    const uint8_t progressLeds = (uint16_t)transition.getProgress() * 8 / 100;
+    meg.setExtraLeds(0xFF00 >> progressLeds);
+}